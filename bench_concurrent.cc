@@ -0,0 +1,95 @@
+// Przepustowość kolejki współbieżnej w zależności od liczby wątków,
+// w porównaniu z PriorityQueue chronioną jednym muteksem, dla kluczy int
+// (opisy części w słowach atomowych) i std::string (kopie par podmieniane
+// atomowo).
+// Użycie: ./bench_concurrent [operacje na wątek] [maksymalna liczba wątków]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentpriorityqueue.hh"
+
+// Jedna kolejka, jeden muteks - tak jak dotychczas
+template <typename K>
+class LockedPriorityQueue {
+    std::mutex lock;
+    PriorityQueue<K, int> queue;
+
+   public:
+    void insert(const K& key, int value) {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.insert(key, value);
+    }
+    void deleteMin() {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.deleteMin();
+    }
+};
+
+template <typename K>
+K make_key(int i);
+
+template <>
+int make_key<int>(int i) {
+    return i;
+}
+
+template <>
+std::string make_key<std::string>(int i) {
+    return "key " + std::to_string(i);
+}
+
+// Każdy wątek na zmianę wstawia i usuwa minimum (po wstępnym wypełnieniu)
+template <typename K, typename Queue>
+double run(Queue& queue, int threads, int ops) {
+    for (int i = 0; i < 100000; ++i) queue.insert(make_key<K>(-1 - i), i);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&queue, t, ops] {
+            std::mt19937 twister(t);
+            for (int i = 0; i < ops; ++i) {
+                if (i % 2 == 0)
+                    queue.insert(make_key<K>(t * ops + i),
+                                 twister() % 1000000);
+                else
+                    queue.deleteMin();
+            }
+        });
+    for (std::thread& w : workers) w.join();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return threads * ops / elapsed.count();
+}
+
+template <typename K>
+void compare(const char* title, int ops, int max_threads) {
+    std::printf("%s\n%8s %16s %16s %8s\n", title, "threads", "mutex [op/s]",
+                "sharded [op/s]", "ratio");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        LockedPriorityQueue<K> locked;
+        ConcurrentPriorityQueue<K, int> sharded;
+        double a = run<K>(locked, threads, ops);
+        double b = run<K>(sharded, threads, ops);
+        std::printf("%8d %16.0f %16.0f %8.2f\n", threads, a, b, b / a);
+    }
+}
+
+int main(int argc, char** argv) {
+    int ops = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int max_threads = argc > 2 ? std::atoi(argv[2])
+                               : 2 * std::thread::hardware_concurrency();
+    if (max_threads < 1) max_threads = 1;
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    compare<int>("int keys", ops, max_threads);
+    compare<std::string>("std::string keys", ops, max_threads);
+    return 0;
+}
@@ -0,0 +1,125 @@
+// Przepustowość i błąd rank zrelaksowanej kolejki (MultiQueue).
+// Każdy wątek na zmianę wstawia parę i zdejmuje parę przez popMin; każda
+// operacja dostaje numer z globalnego licznika (wstawienie przed wywołaniem,
+// usunięcie po nim, więc para jest zawsze wstawiona wcześniej niż usunięta).
+// Po pomiarze odtwarzamy operacje w kolejności numerów na dokładnym drzewie
+// z rangami i dla każdego popMin liczymy, ile par w kolejce było mniejszych.
+// Gdy wątków jest więcej niż rdzeni, wątek wywłaszczony między pobraniem
+// numeru a operacją zawyża ogon rozkładu.
+// Użycie: ./bench_multiqueue [operacje na wątek] [wątki] [kolejki na wątek]
+//         [losowane kolejki]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "multiqueue.hh"
+
+// (wartość, klucz) - klucze są unikalne
+using entry = std::pair<int, int>;
+using ranked_set =
+    __gnu_pbds::tree<entry, __gnu_pbds::null_type, std::less<entry>,
+                     __gnu_pbds::rb_tree_tag,
+                     __gnu_pbds::tree_order_statistics_node_update>;
+
+struct operation {
+    unsigned long ticket;
+    bool insert;
+    entry pair;
+};
+
+int main(int argc, char** argv) {
+    int ops = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int threads = argc > 2 ? std::atoi(argv[2])
+                           : std::max(1u, std::thread::hardware_concurrency());
+    int per_thread = argc > 3 ? std::atoi(argv[3]) : 4;
+    unsigned choices = argc > 4 ? std::atoi(argv[4]) : 2;
+    const int prefill = 10000;
+
+    MultiQueue<int, int> queue(threads * per_thread, choices);
+    std::atomic<unsigned long> clock{0};
+    std::vector<std::vector<operation>> logs(threads + 1);
+
+    std::mt19937 twister(1);
+    for (int i = 0; i < prefill; ++i) {
+        entry e(twister() % 1000000, -1 - i);
+        logs[threads].push_back(operation{clock++, true, e});
+        queue.insert(e.second, e.first);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            std::mt19937 twister(t);
+            std::vector<operation>& log = logs[t];
+            log.reserve(ops);
+            int key, value;
+            for (int i = 0; i < ops; ++i) {
+                if (i % 2 == 0) {
+                    entry e(twister() % 1000000, t * ops + i);
+                    log.push_back(operation{clock++, true, e});
+                    queue.insert(e.second, e.first);
+                } else if (queue.popMin(key, value)) {
+                    log.push_back(operation{clock++, false, entry(value, key)});
+                }
+            }
+        });
+    for (std::thread& w : workers) w.join();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::vector<operation> all;
+    for (std::vector<operation>& log : logs)
+        all.insert(all.end(), log.begin(), log.end());
+    std::sort(all.begin(), all.end(),
+              [](const operation& a, const operation& b) {
+                  return a.ticket < b.ticket;
+              });
+
+    ranked_set exact;
+    std::vector<std::size_t> ranks;
+    for (const operation& op : all) {
+        if (op.insert) {
+            exact.insert(op.pair);
+        } else {
+            ranks.push_back(exact.order_of_key(op.pair));
+            exact.erase(op.pair);
+        }
+    }
+    std::sort(ranks.begin(), ranks.end());
+
+    double mean = 0;
+    for (std::size_t r : ranks) mean += r;
+    if (!ranks.empty()) mean /= ranks.size();
+    auto percentile = [&ranks](double p) -> std::size_t {
+        if (ranks.empty()) return 0;
+        return ranks[std::min(ranks.size() - 1,
+                              static_cast<std::size_t>(p * ranks.size()))];
+    };
+
+    std::printf("threads %d, queues %zu, choices %u, hardware threads %u\n",
+                threads, queue.queues(), choices,
+                std::thread::hardware_concurrency());
+    std::printf("throughput: %.0f op/s\n", threads * ops / elapsed.count());
+    std::printf("rank error: mean %.2f, p50 %zu, p90 %zu, p99 %zu, max %zu\n",
+                mean, percentile(0.5), percentile(0.9), percentile(0.99),
+                ranks.empty() ? 0 : ranks.back());
+    std::printf("%12s %10s\n", "rank", "popMin");
+    for (std::size_t low = 0, high = 1; low <= (ranks.empty() ? 0 : ranks.back());
+         low = high, high *= 2) {
+        std::size_t count =
+            std::lower_bound(ranks.begin(), ranks.end(), high) -
+            std::lower_bound(ranks.begin(), ranks.end(), low);
+        std::printf("%5zu..%-6zu %10zu\n", low, high - 1, count);
+    }
+    return 0;
+}
@@ -0,0 +1,512 @@
+// Mikrobenchmarki PriorityQueue (Google Benchmark). Każda operacja jest
+// mierzona dla rozmiarów od 1e2 do BENCH_MAX_SIZE, dla par int, std::string
+// i ciężkiego typu użytkownika oraz dla trzech rozkładów danych.
+// Użycie: make bench (wynik w bench.json); dwa wyniki porównuje
+//   tools/compare.py benchmarks stary.json nowy.json
+// z repozytorium Google Benchmark. Pełny przebieg trwa godzinami (głównie
+// przez rozmiar 1e7), więc zwykle wybiera się przypadki:
+//   make bench BENCH_ARGS=--benchmark_filter='Insert<int'
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bucketqueue.hh"
+#include "daryheap.hh"
+#include "poolallocator.hh"
+#include "priorityqueue.hh"
+#include "radixheap.hh"
+
+#ifndef BENCH_MAX_SIZE
+// Przy 1e7 par std::string albo heavy kopia kolejki i jej oryginał zajmują
+// razem kilka GB - na mniejszych maszynach warto zmniejszyć
+#define BENCH_MAX_SIZE 10000000
+#endif
+
+// Ciężki typ użytkownika: 64 bajty do skopiowania, a porównanie przechodzi
+// przez wszystkie słowa, bo różnią się dopiero ostatnim
+struct heavy {
+    std::uint64_t words[8];
+
+    friend bool operator<(const heavy& lhs, const heavy& rhs) {
+        return std::lexicographical_compare(lhs.words, lhs.words + 8,
+                                            rhs.words, rhs.words + 8);
+    }
+    friend bool operator==(const heavy& lhs, const heavy& rhs) {
+        return std::equal(lhs.words, lhs.words + 8, rhs.words);
+    }
+};
+
+using str = std::string;
+
+template <typename T>
+T make(std::uint64_t x);
+
+template <>
+int make<int>(std::uint64_t x) {
+    return static_cast<int>(x & 0x7fffffff);
+}
+
+// Napisy dłuższe niż bufor SSO, żeby kopia alokowała; dopełnienie zerami
+// zachowuje porządek liczb
+template <>
+str make<str>(std::uint64_t x) {
+    char buffer[24];
+    std::snprintf(buffer, sizeof buffer, "%020llu",
+                  static_cast<unsigned long long>(x));
+    return buffer;
+}
+
+template <>
+heavy make<heavy>(std::uint64_t x) {
+    heavy h;
+    std::fill(h.words, h.words + 7, 0x5555555555555555ull);
+    h.words[7] = x;
+    return h;
+}
+
+// uniform - losowe klucze i wartości z [0, n); sorted - pary rosnące;
+// adversarial - każda wartość jest nowym minimum, a kluczy jest tylko 16,
+// więc changeValue wybiera spośród n / 16 par o tym samym kluczu
+enum distribution { uniform, sorted, adversarial };
+
+template <typename K, typename V>
+std::vector<std::pair<K, V>> make_pairs(std::size_t n, int dist) {
+    std::mt19937_64 twister(n);
+    std::vector<std::pair<K, V>> pairs;
+    pairs.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        switch (dist) {
+            case uniform:
+                pairs.emplace_back(make<K>(twister() % n),
+                                   make<V>(twister() % n));
+                break;
+            case sorted:
+                pairs.emplace_back(make<K>(i), make<V>(i));
+                break;
+            case adversarial:
+                pairs.emplace_back(make<K>(i % 16), make<V>(n - i));
+                break;
+        }
+    }
+    return pairs;
+}
+
+// Dane jednego przypadku; pamiętamy tylko ostatni, bo kolejne benchmarki
+// tej samej funkcji różnią się rozmiarem
+template <typename K, typename V>
+struct workload {
+    std::size_t size;
+    int dist;
+    std::vector<std::pair<K, V>> pairs;
+    PriorityQueue<K, V> queue;
+    // połowy pairs dla merge, tworzone na żądanie
+    std::unique_ptr<PriorityQueue<K, V>> halves[2];
+
+    PriorityQueue<K, V>& half(int i) {
+        if (halves[i] == nullptr) {
+            auto middle = pairs.begin() + pairs.size() / 2;
+            halves[i].reset(i == 0 ? new PriorityQueue<K, V>(pairs.begin(),
+                                                             middle)
+                                   : new PriorityQueue<K, V>(middle,
+                                                             pairs.end()));
+        }
+        return *halves[i];
+    }
+};
+
+template <typename K, typename V>
+workload<K, V>& prepare(const benchmark::State& state, int dist) {
+    static std::unique_ptr<workload<K, V>> last;
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    if (last == nullptr || last->size != n || last->dist != dist) {
+        // stary przypadek zwalniamy przed utworzeniem nowego
+        last.reset();
+        last.reset(new workload<K, V>{n, dist, make_pairs<K, V>(n, dist),
+                                      PriorityQueue<K, V>(), {}});
+        last->queue.assign(last->pairs.begin(), last->pairs.end());
+    }
+    return *last;
+}
+
+template <typename K, typename V, int Dist>
+void Insert(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    for (auto _ : state) {
+        PriorityQueue<K, V> q;
+        for (const std::pair<K, V>& p : w.pairs) q.insert(p.first, p.second);
+        benchmark::DoNotOptimize(q.size());
+        state.PauseTiming();
+        q = PriorityQueue<K, V>();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * w.pairs.size());
+}
+
+template <typename K, typename V, int Dist>
+void DeleteMin(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    for (auto _ : state) {
+        state.PauseTiming();
+        PriorityQueue<K, V> q(w.queue);
+        state.ResumeTiming();
+        while (!q.empty()) q.deleteMin();
+    }
+    state.SetItemsProcessed(state.iterations() * w.queue.size());
+}
+
+template <typename K, typename V, int Dist>
+void DeleteMax(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    for (auto _ : state) {
+        state.PauseTiming();
+        PriorityQueue<K, V> q(w.queue);
+        state.ResumeTiming();
+        while (!q.empty()) q.deleteMax();
+    }
+    state.SetItemsProcessed(state.iterations() * w.queue.size());
+}
+
+// Jedna zmiana na iterację; klucze po kolei, wartości od końca
+template <typename K, typename V, int Dist>
+void ChangeValue(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    PriorityQueue<K, V> q(w.queue);
+    std::size_t n = w.pairs.size(), i = 0;
+    for (auto _ : state) {
+        q.changeValue(w.pairs[i].first, w.pairs[n - 1 - i].second);
+        if (++i == n) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Zmiana wartości, po której para zostaje między sąsiadami: pary (i, 2i)
+// dostają na przemian wartości 2i + 1 i 2i
+template <typename K, typename V>
+void NudgeValue(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<K> keys;
+    std::vector<V> values;
+    for (std::size_t i = 0; i < n; ++i) keys.push_back(make<K>(i));
+    for (std::size_t i = 0; i < 2 * n; ++i) values.push_back(make<V>(i));
+    PriorityQueue<K, V> q;
+    for (std::size_t i = 0; i < n; ++i) q.insert(keys[i], values[2 * i]);
+    std::size_t i = 0, odd = 1;
+    for (auto _ : state) {
+        q.changeValue(keys[i], values[2 * i + odd]);
+        if (++i == n) {
+            i = 0;
+            odd ^= 1;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// 100 największych par strumienia: set_capacity albo insert i deleteMin
+// po przekroczeniu rozmiaru
+template <typename K, typename V, bool Bounded>
+void TopK(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, uniform);
+    const std::size_t k = 100;
+    for (auto _ : state) {
+        PriorityQueue<K, V> q;
+        if (Bounded) q.set_capacity(k);
+        for (const auto& p : w.pairs) {
+            q.insert(p.first, p.second);
+            if (!Bounded && q.size() > k) q.deleteMin();
+        }
+        benchmark::DoNotOptimize(q.size());
+    }
+    state.SetItemsProcessed(state.iterations() * w.pairs.size());
+}
+
+// Percentyle żywej kolejki (RankedTreeBackend): zmiana wartości jednej
+// pary, a po niej mediana, 99. percentyl i liczba par w przedziale
+template <typename K, typename V>
+void Percentile(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<K> keys;
+    std::vector<V> values;
+    for (std::size_t i = 0; i < n; ++i) keys.push_back(make<K>(i));
+    for (std::size_t i = 0; i < 2 * n; ++i) values.push_back(make<V>(i));
+    PriorityQueue<K, V, RankedTreeBackend> q;
+    for (std::size_t i = 0; i < n; ++i) q.insert(keys[i], values[2 * i]);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        q.changeValue(keys[i], values[(7 * i) % (2 * n)]);
+        benchmark::DoNotOptimize(q.nth_by_value(n / 2));
+        benchmark::DoNotOptimize(q.nth_by_value(n - n / 100 - 1));
+        benchmark::DoNotOptimize(q.count_in_range(values[n / 2], values[n]));
+        if (++i == n) i = 0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename K, typename V, int Dist>
+void Merge(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    for (auto _ : state) {
+        state.PauseTiming();
+        PriorityQueue<K, V> a(w.half(0)), b(w.half(1));
+        state.ResumeTiming();
+        a.merge(b);
+        benchmark::DoNotOptimize(a.size());
+        state.PauseTiming();
+        a = PriorityQueue<K, V>();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * w.pairs.size());
+}
+
+template <typename K, typename V, int Dist>
+void Copy(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    for (auto _ : state) {
+        PriorityQueue<K, V> copy(w.queue);
+        benchmark::DoNotOptimize(copy.size());
+        state.PauseTiming();
+        copy = PriorityQueue<K, V>();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * w.queue.size());
+}
+
+// Równe kolejki - oba operatory muszą przejść wszystkie pary
+template <typename K, typename V, int Dist>
+void Equal(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    PriorityQueue<K, V> other(w.queue);
+    for (auto _ : state) benchmark::DoNotOptimize(w.queue == other);
+    state.SetItemsProcessed(state.iterations() * w.queue.size());
+}
+
+template <typename K, typename V, int Dist>
+void Less(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    PriorityQueue<K, V> other(w.queue);
+    for (auto _ : state) benchmark::DoNotOptimize(w.queue < other);
+    state.SetItemsProcessed(state.iterations() * w.queue.size());
+}
+
+template <typename K, typename V, int Dist>
+void Swap(benchmark::State& state) {
+    workload<K, V>& w = prepare<K, V>(state, Dist);
+    PriorityQueue<K, V> a(w.queue), b;
+    for (auto _ : state) {
+        a.swap(b);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Partie po 64 pary przez insert_many na przemian z 64 wywołaniami
+// deleteMin, przy stałym rozmiarze kolejki; Pooled wybiera PoolAllocator
+// zamiast domyślnego alokatora
+template <typename K, typename V, bool Pooled>
+void BatchChurn(benchmark::State& state) {
+    using pair_type = std::pair<const K, V>;
+    using allocator =
+        typename std::conditional<Pooled, PoolAllocator<pair_type>,
+                                  std::allocator<pair_type>>::type;
+    const std::size_t batch = 64;
+    workload<K, V>& w = prepare<K, V>(state, uniform);
+    PriorityQueue<K, V, TreeBackend, allocator> q(w.pairs.begin(),
+                                                  w.pairs.end());
+    std::size_t n = w.pairs.size(), i = 0;
+    for (auto _ : state) {
+        std::size_t end = std::min(i + batch, n);
+        q.insert_many(w.pairs.begin() + i, w.pairs.begin() + end);
+        for (std::size_t j = i; j < end; ++j) q.deleteMin();
+        i = (end == n) ? 0 : end;
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+
+// Wartości z [0, 4096) (poziomy priorytetów), na przemian insert
+// i deleteMin przy stałym rozmiarze kolejki; silnik drzewiasty albo
+// kubełkowy
+template <typename Backend>
+void LevelChurn(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::mt19937_64 twister(n);
+    std::vector<std::pair<int, int>> pairs;
+    pairs.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        pairs.emplace_back(make<int>(twister() % n),
+                           static_cast<int>(twister() % 4096));
+    QueueFor<int, int, Backend> q;
+    for (const std::pair<int, int>& p : pairs) q.insert(p.first, p.second);
+    std::size_t i = 0;
+    for (auto _ : state) {
+        q.insert(pairs[i].first, pairs[i].second);
+        q.deleteMin();
+        i = (i + 1 == n) ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Graf losowy o n wierzchołkach i 8 krawędziach wychodzących z każdego
+// (wagi z [1, 1000]) w postaci list sąsiedztwa upakowanych w tablice
+struct graph {
+    std::vector<std::size_t> first;  // krawędzie u to [first[u], first[u + 1])
+    std::vector<int> target;
+    std::vector<unsigned> weight;
+
+    explicit graph(std::size_t n) : first(n + 1) {
+        const std::size_t degree = 8;
+        std::mt19937_64 twister(n);
+        for (std::size_t u = 0; u < n; ++u) {
+            first[u] = u * degree;
+            for (std::size_t i = 0; i < degree; ++i) {
+                target.push_back(static_cast<int>(twister() % n));
+                weight.push_back(static_cast<unsigned>(twister() % 1000) + 1);
+            }
+        }
+        first[n] = n * degree;
+    }
+};
+
+// Algorytm Dijkstry z wierzchołka 0: zmniejszenie odległości to changeValue
+// (każdy wierzchołek jest w kolejce najwyżej raz); silniki drzewiaste albo
+// kopiec pozycyjny
+template <typename Backend>
+void Dijkstra(benchmark::State& state) {
+    const unsigned infinity = std::numeric_limits<unsigned>::max();
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    graph g(n);
+    std::vector<unsigned> dist(n);
+    std::vector<bool> done(n);
+    for (auto _ : state) {
+        std::fill(dist.begin(), dist.end(), infinity);
+        std::fill(done.begin(), done.end(), false);
+        QueueFor<int, unsigned, Backend> q;
+        dist[0] = 0;
+        q.insert(0, 0);
+        while (!q.empty()) {
+            int u = q.minKey();
+            q.deleteMin();
+            done[u] = true;
+            for (std::size_t e = g.first[u]; e < g.first[u + 1]; ++e) {
+                int v = g.target[e];
+                unsigned d = dist[u] + g.weight[e];
+                if (done[v] || d >= dist[v]) continue;
+                if (dist[v] == infinity)
+                    q.insert(v, d);
+                else
+                    q.changeValue(v, d);
+                dist[v] = d;
+            }
+        }
+        benchmark::DoNotOptimize(dist.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Jak Dijkstra, ale zmniejszenie odległości przez uchwyt zapamiętany przy
+// insert, bez wyszukiwania klucza
+template <unsigned D>
+void DijkstraHandles(benchmark::State& state) {
+    using queue = HeapQueue<int, unsigned, DaryHeapBackend<D>>;
+    const unsigned infinity = std::numeric_limits<unsigned>::max();
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    graph g(n);
+    std::vector<unsigned> dist(n);
+    std::vector<bool> done(n);
+    std::vector<typename queue::handle> handles(n);
+    for (auto _ : state) {
+        std::fill(dist.begin(), dist.end(), infinity);
+        std::fill(done.begin(), done.end(), false);
+        queue q;
+        dist[0] = 0;
+        q.insert(0, 0);
+        while (!q.empty()) {
+            int u = q.minKey();
+            q.deleteMin();
+            done[u] = true;
+            for (std::size_t e = g.first[u]; e < g.first[u + 1]; ++e) {
+                int v = g.target[e];
+                unsigned d = dist[u] + g.weight[e];
+                if (done[v] || d >= dist[v]) continue;
+                if (dist[v] == infinity)
+                    handles[v] = q.insert(v, d);
+                else
+                    handles[v] = q.changeValue(handles[v], d);
+                dist[v] = d;
+            }
+        }
+        benchmark::DoNotOptimize(dist.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+void graph_sizes(benchmark::internal::Benchmark* b) {
+    for (long n = 1000; n <= BENCH_MAX_SIZE && n <= 1000000; n *= 10)
+        b->Arg(n);
+    b->Unit(benchmark::kMillisecond);
+}
+
+void sizes(benchmark::internal::Benchmark* b) {
+    for (long n = 100; n <= BENCH_MAX_SIZE; n *= 10) b->Arg(n);
+    b->Unit(benchmark::kMicrosecond);
+}
+
+#define PQ_BENCHMARK_TYPES(op, K, V)                     \
+    BENCHMARK_TEMPLATE(op, K, V, uniform)->Apply(sizes); \
+    BENCHMARK_TEMPLATE(op, K, V, sorted)->Apply(sizes);  \
+    BENCHMARK_TEMPLATE(op, K, V, adversarial)->Apply(sizes)
+
+#define PQ_BENCHMARK(op)              \
+    PQ_BENCHMARK_TYPES(op, int, int); \
+    PQ_BENCHMARK_TYPES(op, str, str); \
+    PQ_BENCHMARK_TYPES(op, heavy, heavy)
+
+PQ_BENCHMARK(Insert);
+PQ_BENCHMARK(DeleteMin);
+PQ_BENCHMARK(DeleteMax);
+PQ_BENCHMARK(ChangeValue);
+PQ_BENCHMARK(Merge);
+PQ_BENCHMARK(Copy);
+PQ_BENCHMARK(Equal);
+PQ_BENCHMARK(Less);
+PQ_BENCHMARK(Swap);
+
+BENCHMARK_TEMPLATE(NudgeValue, int, int)->Apply(sizes);
+BENCHMARK_TEMPLATE(NudgeValue, str, str)->Apply(sizes);
+BENCHMARK_TEMPLATE(NudgeValue, heavy, heavy)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(Percentile, int, int)->Apply(sizes);
+BENCHMARK_TEMPLATE(Percentile, str, str)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(TopK, int, int, false)->Apply(sizes);
+BENCHMARK_TEMPLATE(TopK, int, int, true)->Apply(sizes);
+BENCHMARK_TEMPLATE(TopK, str, str, false)->Apply(sizes);
+BENCHMARK_TEMPLATE(TopK, str, str, true)->Apply(sizes);
+
+#define PQ_CHURN_BENCHMARK(K, V)                                \
+    BENCHMARK_TEMPLATE(BatchChurn, K, V, false)->Apply(sizes); \
+    BENCHMARK_TEMPLATE(BatchChurn, K, V, true)->Apply(sizes)
+
+PQ_CHURN_BENCHMARK(int, int);
+PQ_CHURN_BENCHMARK(str, str);
+
+BENCHMARK_TEMPLATE(LevelChurn, TreeBackend)->Apply(sizes);
+BENCHMARK_TEMPLATE(LevelChurn, BucketQueueBackend<4096>)->Apply(sizes);
+
+BENCHMARK_TEMPLATE(Dijkstra, TreeBackend)->Apply(graph_sizes);
+BENCHMARK_TEMPLATE(Dijkstra, RankedTreeBackend)->Apply(graph_sizes);
+BENCHMARK_TEMPLATE(Dijkstra, RadixHeapBackend)->Apply(graph_sizes);
+BENCHMARK_TEMPLATE(Dijkstra, DaryHeapBackend<4>)->Apply(graph_sizes);
+BENCHMARK_TEMPLATE(DijkstraHandles, 2)->Apply(graph_sizes);
+BENCHMARK_TEMPLATE(DijkstraHandles, 4)->Apply(graph_sizes);
+BENCHMARK_TEMPLATE(DijkstraHandles, 8)->Apply(graph_sizes);
+
+BENCHMARK_MAIN();
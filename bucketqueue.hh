@@ -0,0 +1,439 @@
+#ifndef _JNP1_BUCKETQUEUE_HH_
+#define _JNP1_BUCKETQUEUE_HH_
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+class PriorityQueueValueOutOfRangeException : public std::exception {
+   public:
+    PriorityQueueValueOutOfRangeException() = default;
+    virtual const char* what() const noexcept(true) {
+        return "Value is out of the range of the bucket queue.";
+    }
+};
+
+// Silnik kubełkowy dla całkowitych wartości z przedziału [0, Levels):
+// każda wartość ma własny kubełek (listę węzłów z tą wartością), a niepuste
+// kubełki zaznacza dwupoziomowa mapa bitowa, więc minimum i maksimum to
+// dwa skany bitów (dla Levels <= 4096 - po jednym słowie). insert,
+// deleteMin, deleteMax i merge w O(1) (merge - O(queue.size())), bez
+// porównań kluczy; minValue, maxValue, minKey i maxKey w O(Levels / 4096).
+// Indeks po kluczu (dla changeValue) jest uzupełniany leniwie, jak
+// w PairingHeapBackend, i tak jak tam każda wstawiona para ma własny węzeł,
+// więc silnik działa z HeapQueue.
+// Wartość spoza przedziału zgłasza PriorityQueueValueOutOfRangeException.
+// Pary z równą wartością są w kubełku w dowolnej kolejności, więc minKey
+// i maxKey zwracają dowolny z kluczy o skrajnej wartości.
+//   HeapQueue<int, unsigned short, BucketQueueBackend<4096>> queue;
+template <std::size_t Levels>
+struct BucketQueueBackend {
+    static_assert(Levels > 0, "bucket queue needs at least one level");
+};
+
+template <std::size_t Levels>
+struct is_heap_backend<BucketQueueBackend<Levels>> : std::true_type {};
+
+template <typename K, typename V, std::size_t Levels, typename Alloc>
+class HeapQueue<K, V, BucketQueueBackend<Levels>, Alloc> {
+    static_assert(std::is_integral<V>::value && !std::is_same<V, bool>::value,
+                  "BucketQueueBackend needs an integral value type");
+
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+
+   protected:
+    struct node {
+        // sąsiedzi na liście kubełka
+        node* prev = nullptr;
+        node* next = nullptr;
+        // indeks po kluczu; węzeł spoza indeksu (indexed == false) czeka na
+        // liście pending, powiązanej przez by_key.left i by_key.right
+        priority_queue_detail::tree_hook<node> by_key;
+        bool indexed = false;
+        unsigned priority;
+        K key;
+        V value;
+
+        node(const K& key, const V& value, unsigned priority)
+            : priority(priority), key(key), value(value) {}
+    };
+
+    // Porządek par; wartości to liczby całkowite, więc porównujemy je wprost
+    class ValueKeyComparer {
+       public:
+        bool operator()(const node* lhs, const node* rhs) const {
+            if (lhs->value != rhs->value) return lhs->value < rhs->value;
+            return priority_queue_detail::compare_less(lhs->key, rhs->key);
+        }
+    };
+
+    using word = std::uint64_t;
+    static constexpr std::size_t word_bits = 64;
+    static constexpr std::size_t word_count =
+        (Levels + word_bits - 1) / word_bits;
+    static constexpr std::size_t summary_count =
+        (word_count + word_bits - 1) / word_bits;
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    template <typename T>
+    using scratch_vector = priority_queue_detail::scratch_vector<T, Alloc>;
+
+    // węzły (z pamięcią) i ich indeks po kluczu (dla changeValue)
+    priority_queue_detail::lazy_key_index<node, Alloc> nodes;
+    // głowy list kubełków; kubełki i mapy bitowe tworzymy przy pierwszym
+    // wstawieniu, więc pusta kolejka nie zajmuje pamięci
+    scratch_vector<node*> buckets;
+    // bit v - kubełek v jest niepusty
+    scratch_vector<word> used;
+    // bit w - słowo used[w] jest niezerowe
+    scratch_vector<word> summary;
+    size_type total = 0;
+
+   protected:
+    static void check_range(const V& value) {
+        using unsigned_value = typename std::make_unsigned<V>::type;
+        // wartości ujemne po konwersji są ogromne, więc też odpadają
+        if (static_cast<std::uintmax_t>(static_cast<unsigned_value>(value)) >=
+            Levels)
+            throw PriorityQueueValueOutOfRangeException();
+    }
+
+    static size_type level(const V& value) noexcept {
+        return static_cast<size_type>(value);
+    }
+
+    // Tworzy kubełki i mapy bitowe, jeśli ich jeszcze nie ma [O(Levels)];
+    // może rzucić, wtedy kolejka dalej nie ma kubełków (gotowość poznajemy
+    // po summary, tworzonej na końcu)
+    void reserve_buckets() {
+        if (!summary.empty()) return;
+        buckets.resize(Levels, nullptr);
+        used.resize(word_count, 0);
+        summary.resize(summary_count, 0);
+    }
+
+    // Operacje na kubełkach i mapach bitowych; nie rzucają
+
+    void push_bucket(node* n) noexcept {
+        size_type v = level(n->value);
+        node*& head = buckets[v];
+        n->prev = nullptr;
+        n->next = head;
+        if (head != nullptr) head->prev = n;
+        head = n;
+        size_type w = v / word_bits;
+        used[w] |= word(1) << (v % word_bits);
+        summary[w / word_bits] |= word(1) << (w % word_bits);
+    }
+
+    void pop_bucket(node* n) noexcept {
+        size_type v = level(n->value);
+        if (n->prev != nullptr)
+            n->prev->next = n->next;
+        else
+            buckets[v] = n->next;
+        if (n->next != nullptr) n->next->prev = n->prev;
+        n->prev = n->next = nullptr;
+        if (buckets[v] != nullptr) return;
+
+        size_type w = v / word_bits;
+        used[w] &= ~(word(1) << (v % word_bits));
+        if (used[w] == 0)
+            summary[w / word_bits] &= ~(word(1) << (w % word_bits));
+    }
+
+    // Najmniejszy i największy niepusty kubełek; kolejka nie może być pusta
+    // [O(summary_count)]
+    size_type lowest() const noexcept {
+        size_type s = 0;
+        while (summary[s] == 0) ++s;
+        size_type w = s * word_bits + __builtin_ctzll(summary[s]);
+        return w * word_bits + __builtin_ctzll(used[w]);
+    }
+    size_type highest() const noexcept {
+        size_type s = summary_count - 1;
+        while (summary[s] == 0) --s;
+        size_type w = (s + 1) * word_bits - 1 - __builtin_clzll(summary[s]);
+        return (w + 1) * word_bits - 1 - __builtin_clzll(used[w]);
+    }
+
+    // Wywołuje f(n) dla każdego węzła, kubełkami rosnąco; f może zniszczyć
+    // n albo przepiąć go do innej kolejki [O(size() + summary_count)]
+    template <typename F>
+    void for_each_node(F f) const {
+        for (size_type s = 0; s < summary.size(); ++s) {
+            for (word ws = summary[s]; ws != 0; ws &= ws - 1) {
+                size_type w = s * word_bits + __builtin_ctzll(ws);
+                for (word bits = used[w]; bits != 0; bits &= bits - 1) {
+                    size_type v = w * word_bits + __builtin_ctzll(bits);
+                    for (node* n = buckets[v]; n != nullptr;) {
+                        node* next = n->next;
+                        f(n);
+                        n = next;
+                    }
+                }
+            }
+        }
+    }
+
+    // Opróżnia kubełki, nie dotykając węzłów [O(size() + summary_count)]
+    void clear_buckets() noexcept {
+        for (size_type s = 0; s < summary.size(); ++s) {
+            for (word ws = summary[s]; ws != 0; ws &= ws - 1) {
+                size_type w = s * word_bits + __builtin_ctzll(ws);
+                for (word bits = used[w]; bits != 0; bits &= bits - 1)
+                    buckets[w * word_bits + __builtin_ctzll(bits)] = nullptr;
+                used[w] = 0;
+            }
+            summary[s] = 0;
+        }
+    }
+
+    // Usuwa n z kolejki [O(log size()), a O(1) dla węzłów spoza indeksu]
+    void remove(node* n) noexcept {
+        pop_bucket(n);
+        nodes.unindex(n);
+        nodes.destroy(n);
+        --total;
+    }
+
+    // Kubełki wystarczy opróżnić - węzły niszczy indeks
+    void destroy_all() noexcept {
+        clear_buckets();
+        nodes.destroy_all();
+        total = 0;
+    }
+
+    // Wszystkie węzły posortowane po wartości, a potem po kluczu
+    // [O(size() * log (rozmiar kubełka) + summary_count)] - kubełki są już
+    // w kolejności wartości, sortujemy tylko ich wnętrza
+    scratch_vector<const node*> sorted_nodes() const {
+        scratch_vector<const node*> out(get_allocator());
+        out.reserve(total);
+        size_type bucket_begin = 0;
+        auto sort_bucket = [&]() {
+            std::sort(out.begin() + bucket_begin, out.end(),
+                      ValueKeyComparer());
+            bucket_begin = out.size();
+        };
+        for_each_node([&](node* n) {
+            if (!out.empty() && out.back()->value != n->value) sort_bucket();
+            out.push_back(n);
+        });
+        sort_bucket();
+        return out;
+    }
+
+   public:
+    // Konstruktor bezparametrowy tworzący pustą kolejkę [O(1)]
+    HeapQueue() : HeapQueue(Alloc()) {}
+
+    // Pusta kolejka korzystająca z alokatora alloc [O(1)]
+    explicit HeapQueue(const Alloc& alloc)
+        : nodes(alloc), buckets(alloc), used(alloc), summary(alloc) {}
+
+    // Konstruktor kopiujący [O(queue.size() + Levels)]
+    HeapQueue(const HeapQueue& queue)
+        : HeapQueue(queue,
+                    alloc_traits::select_on_container_copy_construction(
+                        queue.get_allocator())) {}
+
+    // Kopia queue w pamięci z alokatora alloc [O(queue.size() + Levels)];
+    // kopie trafiają na pending. Jeśli kopiowanie rzuci, niszczymy kopie.
+    HeapQueue(const HeapQueue& queue, const Alloc& alloc)
+        : HeapQueue(alloc) {
+        if (queue.empty()) return;
+        try {
+            reserve_buckets();
+            queue.for_each_node([this](node* n) {
+                node* twin = nodes.create(n->key, n->value);
+                nodes.push_pending(twin);
+                push_bucket(twin);
+                ++total;
+            });
+        } catch (...) {
+            destroy_all();
+            throw;
+        }
+    }
+
+    // Konstruktor przenoszący [O(1)]
+    HeapQueue(HeapQueue&& queue) noexcept
+        : HeapQueue(queue.get_allocator()) {
+        this->swap(queue);
+    }
+
+    // [O(size() + Levels / 4096), a dla trywialnie niszczalnych K i V
+    // O(liczba kawałków puli)]
+    ~HeapQueue() {
+        if (!std::is_trivially_destructible<node>::value) destroy_all();
+    }
+
+    // Operator przypisania [O(queue.size()) dla użycia P = Q, a O(1) dla użycia
+    // P = move(Q)]; alokator przechodzi tak jak w silniku drzewiastym
+    HeapQueue& operator=(const HeapQueue& queue) {
+        if (this == &queue) return *this;
+        HeapQueue tmp(
+            queue, alloc_traits::propagate_on_container_copy_assignment::value
+                       ? queue.get_allocator()
+                       : get_allocator());
+        this->swap(tmp);
+        return *this;
+    }
+
+    HeapQueue& operator=(HeapQueue&& queue) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value) {
+        if (this == &queue) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            get_allocator() == queue.get_allocator()) {
+            HeapQueue tmp(std::move(queue));
+            this->swap(tmp);
+        } else {
+            HeapQueue tmp(queue, get_allocator());
+            this->swap(tmp);
+        }
+        return *this;
+    }
+
+    // Kopia alokatora kolejki [O(1)]
+    Alloc get_allocator() const noexcept { return nodes.get_allocator(); }
+
+    // [O(1)]
+    bool empty() const noexcept { return total == 0; }
+    size_type size() const noexcept { return total; }
+
+    // Wstawienie pary [O(1), a przy pierwszym wstawieniu O(Levels)]; silna
+    // gwarancja
+    void insert(const K& key, const V& value) {
+        check_range(value);
+        reserve_buckets();
+        node* n = nodes.create(key, value);
+        nodes.push_pending(n);
+        push_bucket(n);
+        ++total;
+    }
+
+    // Najmniejsza i największa wartość oraz ich klucze [O(Levels / 4096)]
+    const V& minValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return buckets[lowest()]->value;
+    }
+    const V& maxValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return buckets[highest()]->value;
+    }
+    const K& minKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return buckets[lowest()]->key;
+    }
+    const K& maxKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return buckets[highest()]->key;
+    }
+
+    // Usunięcie pary o najmniejszej / największej wartości [O(1) dla par
+    // spoza indeksu, O(log size()) dla pozostałych], no-throw
+    void deleteMin() {
+        if (empty()) return;
+        remove(buckets[lowest()]);
+    }
+
+    void deleteMax() {
+        if (empty()) return;
+        remove(buckets[highest()]);
+    }
+
+    // Zmiana wartości w dowolnej parze o kluczu key [O(log size()) plus
+    // uzupełnienie indeksu]; klucz się nie zmienia, więc węzeł zostaje
+    // w indeksie na swoim miejscu i przechodzi tylko do innego kubełka.
+    // Silna gwarancja - porównania dzieją się przed zmianą.
+    void changeValue(const K& key, const V& value) {
+        check_range(value);
+        nodes.flush();
+        node* n = nodes.find(key);
+        if (n == nullptr) throw PriorityQueueNotFoundException();
+        pop_bucket(n);
+        n->value = value;
+        push_bucket(n);
+    }
+
+    // Scalenie z queue [O(queue.size() + Levels / 4096)], bez porównań
+    // i no-throw dla równych alokatorów: węzły queue przechodzą do kubełków
+    // *this i na pending. Przy różnych alokatorach scalamy kopię queue.
+    void merge(HeapQueue& queue) {
+        if (this == &queue || queue.empty()) return;
+        if (!(get_allocator() == queue.get_allocator())) {
+            HeapQueue copy(queue, get_allocator());
+            HeapQueue emptied(queue.get_allocator());
+            merge(copy);
+            queue.swap(emptied);
+            return;
+        }
+        if (empty()) {
+            this->swap(queue);
+            return;
+        }
+
+        queue.for_each_node([this](node* n) { push_bucket(n); });
+        nodes.splice(queue.nodes);
+        total += queue.total;
+        queue.clear_buckets();
+        queue.total = 0;
+    }
+
+    // [O(1)], gwarancja no-throw; alokatory jak w silniku drzewiastym
+    void swap(HeapQueue& queue) noexcept {
+        if (this == &queue) return;
+        nodes.swap(queue.nodes);
+        buckets.swap(queue.buckets);
+        used.swap(queue.used);
+        summary.swap(queue.summary);
+        std::swap(total, queue.total);
+    }
+
+    friend void swap(HeapQueue& lhs, HeapQueue& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    // Porównania [O(size() * log (rozmiar kubełka))] - ciągi par
+    // posortowanych po wartości, a potem po kluczu
+    friend bool operator==(const HeapQueue& lhs, const HeapQueue& rhs) {
+        using priority_queue_detail::compare_equal;
+        if (lhs.total != rhs.total) return false;
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        for (size_type i = 0; i < a.size(); ++i)
+            if (a[i]->value != b[i]->value ||
+                !compare_equal(a[i]->key, b[i]->key))
+                return false;
+        return true;
+    }
+    friend bool operator!=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const HeapQueue& lhs, const HeapQueue& rhs) {
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(),
+                                            b.end(), ValueKeyComparer());
+    }
+    friend bool operator>(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs > rhs);
+    }
+    friend bool operator>=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs < rhs);
+    }
+};
+
+#endif /* end of include guard: _JNP1_BUCKETQUEUE_HH_ */
@@ -0,0 +1,327 @@
+#ifndef _JNP1_CONCURRENTPRIORITYQUEUE_HH_
+#define _JNP1_CONCURRENTPRIORITYQUEUE_HH_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "priorityqueue.hh"
+
+// Kolejka priorytetowa dla wielu wątków. Pary są rozdzielane po haszu klucza
+// między części (shards) - każda to zwykła PriorityQueue z własnym muteksem,
+// więc wszystkie pary o danym kluczu są w jednej części i changeValue blokuje
+// tylko ją.
+//
+// Gdy K i V są typami trywialnymi, każda część publikuje swoje skrajne pary
+// w słowach atomowych chronionych licznikiem wersji (seqlock): piszący pod
+// muteksem części ustawia nieparzystą wersję, zapisuje słowa i zwiększa
+// wersję znowu, a czytający kopiuje słowa i ponawia odczyt, gdy wersja się
+// zmieniła. Dla pozostałych typów kopiowanie pary w trakcie zapisu byłoby
+// wyścigiem, więc część publikuje niezmienną kopię skrajnych par przez
+// std::shared_ptr podmieniany atomowo (std::atomic_load / std::atomic_store);
+// nowa kopia powstaje tylko wtedy, gdy skrajne pary się zmieniły. W obu
+// przypadkach minValue czyta opisy bez blokowania części, a deleteMin
+// blokuje tylko wybraną część i sprawdza, czy jej opis się nie zmienił.
+//
+// Każda część jest dokładna, ale wybór części opiera się na opisach czytanych
+// po kolei, więc operacja może nie zauważyć pary wstawianej w tym samym
+// czasie do innej części. Metody zwracające pary zwracają kopie.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class ConcurrentPriorityQueue {
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+
+   protected:
+    // Z kopii słów wolno odtworzyć tylko obiekty typów trywialnych
+    static constexpr bool lock_free_summary =
+        std::is_trivial<K>::value && std::is_trivial<V>::value;
+    using summary_tag = std::integral_constant<bool, lock_free_summary>;
+
+    // Skrajne pary niepustej części
+    struct extremes {
+        K min_key;
+        V min_value;
+        K max_key;
+        V max_value;
+    };
+
+    using word = std::uintptr_t;
+    static constexpr std::size_t summary_words =
+        lock_free_summary ? (sizeof(extremes) + sizeof(word) - 1) / sizeof(word)
+                          : 1;
+
+    struct shard {
+        std::mutex lock;
+        PriorityQueue<K, V> queue;
+        // nieparzysta w trakcie zapisu opisu; rośnie, gdy skrajne pary się
+        // zmieniają, więc służy też do sprawdzania, czy część zmieniła się
+        // od odczytu
+        std::atomic<unsigned> version{0};
+        std::atomic<bool> filled{false};
+        // kopia extremes, gdy filled (tylko dla lock_free_summary)
+        std::atomic<word> summary[summary_words];
+        // pozostałe typy: kopia skrajnych par albo nullptr, gdy część jest
+        // pusta lub (stale) nie udało się skopiować par
+        std::shared_ptr<const extremes> snapshot;
+        std::atomic<bool> stale{false};
+
+        shard() {
+            for (std::atomic<word>& w : summary) w.store(0);
+        }
+    };
+
+    std::unique_ptr<shard[]> shards;
+    size_type shard_count;
+    std::atomic<size_type> total{0};
+    Hash hash;
+
+    shard& shard_of(const K& key) { return shards[hash(key) % shard_count]; }
+
+    // Odświeża opis części s; wywoływać pod blokadą s po każdej zmianie jej
+    // kolejki. Wersję zmieniamy tylko wtedy, gdy skrajne pary się zmieniły.
+    static void publish(shard& s) noexcept { publish(s, summary_tag()); }
+
+    static void publish(shard& s, std::false_type) noexcept {
+        try {
+            refresh(s);
+        } catch (...) {
+            // czytający, który zobaczy nullptr, zbuduje opis sam
+            s.stale.store(true);
+            std::atomic_store(&s.snapshot, std::shared_ptr<const extremes>());
+        }
+    }
+
+    // Równoważne według porządku kolejki
+    template <typename T>
+    static bool equivalent(const T& a, const T& b) {
+        using priority_queue_detail::compare_less;
+        return !compare_less(a, b) && !compare_less(b, a);
+    }
+
+    // Buduje kopię skrajnych par części s, jeśli się zmieniły; wywoływać pod
+    // blokadą s. Rzuca, gdy kopiowanie par rzuca - opis się wtedy nie zmienia.
+    static void refresh(shard& s) {
+        const PriorityQueue<K, V>& q = s.queue;
+        std::shared_ptr<const extremes> fresh;
+        if (!q.empty()) {
+            std::shared_ptr<const extremes> old = std::atomic_load(&s.snapshot);
+            if (old && !s.stale.load() &&
+                equivalent(old->min_key, q.minKey()) &&
+                equivalent(old->min_value, q.minValue()) &&
+                equivalent(old->max_key, q.maxKey()) &&
+                equivalent(old->max_value, q.maxValue()))
+                return;
+            fresh = std::make_shared<const extremes>(extremes{
+                q.minKey(), q.minValue(), q.maxKey(), q.maxValue()});
+        }
+        std::atomic_store(&s.snapshot, std::move(fresh));
+        s.stale.store(false);
+    }
+
+    // Kopia skrajnych par części s albo nullptr, gdy część jest pusta
+    static std::shared_ptr<const extremes> load(shard& s) {
+        std::shared_ptr<const extremes> e = std::atomic_load(&s.snapshot);
+        if (e || !s.stale.load()) return e;
+        std::lock_guard<std::mutex> guard(s.lock);
+        refresh(s);
+        return std::atomic_load(&s.snapshot);
+    }
+
+    static void publish(shard& s, std::true_type) noexcept {
+        const PriorityQueue<K, V>& q = s.queue;
+        word fresh[summary_words] = {};
+        if (!q.empty()) {
+            // zerujemy też wyrównanie, żeby porównywać same pary
+            extremes e = extremes();
+            e.min_key = q.minKey();
+            e.min_value = q.minValue();
+            e.max_key = q.maxKey();
+            e.max_value = q.maxValue();
+            std::memcpy(fresh, &e, sizeof e);
+        }
+        // słowa zmienia tylko ten, kto trzyma blokadę, więc czytamy je
+        // bez synchronizacji
+        bool changed = s.filled.load(std::memory_order_relaxed) != !q.empty();
+        for (std::size_t i = 0; i < summary_words && !changed; ++i)
+            changed = s.summary[i].load(std::memory_order_relaxed) != fresh[i];
+        if (!changed) return;
+
+        unsigned v = s.version.load(std::memory_order_relaxed);
+        s.version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < summary_words; ++i)
+            s.summary[i].store(fresh[i], std::memory_order_relaxed);
+        s.filled.store(!q.empty(), std::memory_order_relaxed);
+        s.version.store(v + 2, std::memory_order_release);
+    }
+
+    // Spójna kopia opisu części s; false, gdy część jest pusta. W version
+    // zostaje wersja, z której pochodzi kopia.
+    static bool read(const shard& s, extremes& out, unsigned& version) {
+        word copy[summary_words];
+        bool filled;
+        while (true) {
+            version = s.version.load(std::memory_order_acquire);
+            if (version & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t i = 0; i < summary_words; ++i)
+                copy[i] = s.summary[i].load(std::memory_order_relaxed);
+            filled = s.filled.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.version.load(std::memory_order_relaxed) == version) break;
+        }
+        if (filled) std::memcpy(&out, copy, sizeof out);
+        return filled;
+    }
+
+    // Wybiera część z najmniejszą (max == false) albo największą wartością
+    // na podstawie opisów; zwraca nullptr, gdy wszystkie części są puste.
+    // W best i version zostaje opis wybranej części i jego wersja.
+    shard* pick(bool max, extremes& best, unsigned& version) {
+        using priority_queue_detail::compare_less;
+        shard* chosen = nullptr;
+        for (size_type i = 0; i < shard_count; ++i) {
+            extremes e;
+            unsigned v;
+            if (!read(shards[i], e, v)) continue;
+            if (chosen == nullptr ||
+                (max ? compare_less(best.max_value, e.max_value)
+                     : compare_less(e.min_value, best.min_value))) {
+                chosen = &shards[i];
+                best = e;
+                version = v;
+            }
+        }
+        return chosen;
+    }
+
+    // To samo dla typów nietrywialnych; w best zostaje kopia opisu wybranej
+    // części, której adres służy za wersję (nie zostanie użyty ponownie,
+    // dopóki trzymamy kopię)
+    shard* pick(bool max, std::shared_ptr<const extremes>& best) {
+        using priority_queue_detail::compare_less;
+        shard* chosen = nullptr;
+        for (size_type i = 0; i < shard_count; ++i) {
+            std::shared_ptr<const extremes> e = load(shards[i]);
+            if (!e) continue;
+            if (chosen == nullptr ||
+                (max ? compare_less(best->max_value, e->max_value)
+                     : compare_less(e->min_value, best->min_value))) {
+                chosen = &shards[i];
+                best = std::move(e);
+            }
+        }
+        return chosen;
+    }
+
+    void remove_from(shard& s, bool max) {
+        if (max)
+            s.queue.deleteMax();
+        else
+            s.queue.deleteMin();
+        --total;
+        publish(s);
+    }
+
+    // Usuwa skrajną parę [O(shards + log size())]; jeśli wybrana część
+    // zmieniła się przed jej zablokowaniem, wybieramy jeszcze raz
+    void remove_extreme(bool max) { remove_extreme(max, summary_tag()); }
+
+    void remove_extreme(bool max, std::true_type) {
+        extremes best;
+        unsigned version;
+        while (shard* s = pick(max, best, version)) {
+            std::lock_guard<std::mutex> guard(s->lock);
+            if (s->version.load() != version) continue;
+            remove_from(*s, max);
+            return;
+        }
+    }
+
+    void remove_extreme(bool max, std::false_type) {
+        std::shared_ptr<const extremes> best;
+        while (shard* s = pick(max, best)) {
+            std::lock_guard<std::mutex> guard(s->lock);
+            if (std::atomic_load(&s->snapshot) != best) continue;
+            remove_from(*s, max);
+            return;
+        }
+    }
+
+    std::pair<K, V> extreme(bool max) { return extreme(max, summary_tag()); }
+
+    std::pair<K, V> extreme(bool max, std::true_type) {
+        extremes best;
+        unsigned version;
+        if (pick(max, best, version) == nullptr)
+            throw PriorityQueueEmptyException();
+        return max ? std::pair<K, V>(best.max_key, best.max_value)
+                   : std::pair<K, V>(best.min_key, best.min_value);
+    }
+
+    std::pair<K, V> extreme(bool max, std::false_type) {
+        std::shared_ptr<const extremes> best;
+        if (pick(max, best) == nullptr) throw PriorityQueueEmptyException();
+        return max ? std::pair<K, V>(best->max_key, best->max_value)
+                   : std::pair<K, V>(best->min_key, best->min_value);
+    }
+
+   public:
+    // Konstruktor tworzący pustą kolejkę z podaną liczbą części (domyślnie
+    // dwie na każdy wątek sprzętowy)
+    explicit ConcurrentPriorityQueue(
+        size_type count = 2 * std::thread::hardware_concurrency(),
+        const Hash& hash = Hash())
+        : shards(new shard[count > 0 ? count : 1]),
+          shard_count(count > 0 ? count : 1),
+          hash(hash) {}
+
+    ConcurrentPriorityQueue(const ConcurrentPriorityQueue&) = delete;
+    ConcurrentPriorityQueue& operator=(const ConcurrentPriorityQueue&) = delete;
+
+    // [O(1)]; w trakcie równoległych operacji wynik może być już nieaktualny
+    bool empty() const noexcept { return total.load() == 0; }
+    size_type size() const noexcept { return total.load(); }
+    size_type shards_count() const noexcept { return shard_count; }
+
+    // Wstawienie pary [O(log size())]; blokuje jedną część
+    void insert(const K& key, const V& value) {
+        shard& s = shard_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        s.queue.insert(key, value);
+        ++total;
+        publish(s);
+    }
+
+    // Skrajne wartości i ich klucze [O(shards)]; bez blokowania części
+    V minValue() { return extreme(false).second; }
+    V maxValue() { return extreme(true).second; }
+    K minKey() { return extreme(false).first; }
+    K maxKey() { return extreme(true).first; }
+
+    // Usunięcie pary o najmniejszej / największej wartości
+    // [O(shards + log size())]; blokuje tylko wybraną część
+    void deleteMin() { remove_extreme(false); }
+    void deleteMax() { remove_extreme(true); }
+
+    // Zmiana wartości w dowolnej parze o kluczu key [O(log size())]; blokuje
+    // część wyznaczoną przez hasz klucza
+    void changeValue(const K& key, const V& value) {
+        shard& s = shard_of(key);
+        std::lock_guard<std::mutex> guard(s.lock);
+        s.queue.changeValue(key, value);
+        publish(s);
+    }
+};
+
+#endif /* end of include guard: _JNP1_CONCURRENTPRIORITYQUEUE_HH_ */
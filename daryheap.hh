@@ -0,0 +1,480 @@
+#ifndef _JNP1_DARYHEAP_HH_
+#define _JNP1_DARYHEAP_HH_
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+// Silnik oparty na indeksowanym kopcu d-arnym trzymanym w tablicy: insert,
+// deleteMin i zmiana wartości w O(log_D size()), minValue i minKey w O(1).
+// Dzieci węzła z pozycji i leżą obok siebie na pozycjach D * i + 1 ...
+// D * i + D, więc wybór najmniejszego dziecka czyta jedną-dwie linie
+// pamięci podręcznej, a kopiec jest D / 2 razy płytszy od binarnego.
+// Każda para ma własny węzeł, który pamięta swoją pozycję w tablicy, więc
+// insert zwraca uchwyt, a changeValue(uchwyt, wartość) i erase(uchwyt)
+// obchodzą się bez wyszukiwania klucza. Zmiana wartości tworzy nowy węzeł
+// (V nie musi mieć operatora przypisania) i zwraca jego uchwyt. Indeks po
+// kluczu (dla changeValue(klucz, wartość)) jest uzupełniany leniwie, jak
+// w PairingHeapBackend; maksimum nie jest dostępne. Równe pary mają osobne
+// węzły i uchwyty, więc silnik działa z HeapQueue.
+template <unsigned D = 4>
+struct DaryHeapBackend {
+    static_assert(D >= 2, "DaryHeapBackend needs at least two children");
+};
+
+template <unsigned D>
+struct is_heap_backend<DaryHeapBackend<D>> : std::true_type {};
+
+template <typename K, typename V, unsigned D, typename Alloc>
+class HeapQueue<K, V, DaryHeapBackend<D>, Alloc> {
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+
+   protected:
+    struct node {
+        // indeks po kluczu; węzeł spoza indeksu (indexed == false) czeka na
+        // liście pending, powiązanej przez by_key.left i by_key.right
+        priority_queue_detail::tree_hook<node> by_key;
+        bool indexed = false;
+        unsigned priority;
+        // pozycja w tablicy heap
+        size_type slot = 0;
+        K key;
+        V value;
+
+        node(const K& key, const V& value, unsigned priority)
+            : priority(priority), key(key), value(value) {}
+    };
+
+   public:
+    // Uchwyt pary zwracany przez insert i changeValue. Pozostaje ważny,
+    // dopóki para jest w kolejce: unieważniają go deleteMin (dla tej pary),
+    // changeValue (zwraca nowy uchwyt), erase i zniszczenie kolejki. Po
+    // merge wskazuje parę w kolejce docelowej, po swap i przeniesieniu -
+    // parę w kolejce, do której trafiła; kopia kolejki ma własne uchwyty.
+    class handle {
+       public:
+        handle() noexcept = default;
+
+        friend bool operator==(handle lhs, handle rhs) noexcept {
+            return lhs.target == rhs.target;
+        }
+        friend bool operator!=(handle lhs, handle rhs) noexcept {
+            return lhs.target != rhs.target;
+        }
+
+       private:
+        friend class HeapQueue;
+        explicit handle(node* target) noexcept : target(target) {}
+
+        node* target = nullptr;
+    };
+
+   protected:
+    // Porządek par (dla porównań kolejek)
+    class ValueKeyComparer {
+       public:
+        bool operator()(const node* lhs, const node* rhs) const {
+            using priority_queue_detail::compare_less;
+            if (compare_less(lhs->value, rhs->value)) return true;
+            if (compare_less(rhs->value, lhs->value)) return false;
+            return compare_less(lhs->key, rhs->key);
+        }
+    };
+
+    // Dziennik zamian jednej naprawy kopca; kopiec ma mniej niż 64 poziomy,
+    // a naprawa idzie w jedną stronę
+    using swap_journal = priority_queue_detail::swap_journal<64>;
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    template <typename T>
+    using scratch_vector = priority_queue_detail::scratch_vector<T, Alloc>;
+
+    // węzły (z pamięcią) i ich indeks po kluczu (dla changeValue)
+    priority_queue_detail::lazy_key_index<node, Alloc> nodes;
+    // kopiec minimów; dzieci pozycji i to D * i + 1 ... D * i + D
+    scratch_vector<node*> heap;
+
+   protected:
+    // Operacje na tablicy kopca. Porównania mogą rzucić; wszystkie zamiany
+    // trafiają do dziennika, żeby dało się je cofnąć.
+
+    bool less(size_type i, size_type j) const {
+        return priority_queue_detail::compare_less(heap[i]->value,
+                                                   heap[j]->value);
+    }
+
+    void swap_slots(size_type i, size_type j, swap_journal* journal) noexcept {
+        if (journal != nullptr)
+            journal->swap(heap, i, j);
+        else
+            swap_journal::swap_slots(heap, i, j);
+    }
+
+    // Zwraca true, jeśli element z pozycji i przesunął się w górę
+    bool sift_up(size_type i, swap_journal* journal) {
+        size_type start = i;
+        while (i > 0) {
+            size_type p = (i - 1) / D;
+            if (!less(i, p)) break;
+            swap_slots(i, p, journal);
+            i = p;
+        }
+        return i != start;
+    }
+
+    void sift_down(size_type i, swap_journal* journal) {
+        size_type n = heap.size();
+        while (true) {
+            size_type first = D * i + 1;
+            if (first >= n) return;
+            size_type end = std::min(first + D, n);
+            size_type m = first;
+            for (size_type c = first + 1; c < end; ++c)
+                if (less(c, m)) m = c;
+            if (!less(m, i)) return;
+            swap_slots(i, m, journal);
+            i = m;
+        }
+    }
+
+    // Przywraca własność kopca po zmianie elementu na pozycji i
+    // [O(D * log_D size())]; jeśli porównanie rzuci, tablica wraca do stanu
+    // sprzed naprawy
+    void fix(size_type i) {
+        swap_journal journal;
+        try {
+            if (!sift_up(i, &journal)) sift_down(i, &journal);
+        } catch (...) {
+            journal.undo(heap);
+            throw;
+        }
+    }
+
+    // Wyjmuje z tablicy węzeł z pozycji i (na jego miejsce trafia ostatni)
+    // [O(D * log_D size())]; silna gwarancja
+    void remove_slot(size_type i) {
+        node* removed = heap[i];
+        node* last = heap.back();
+        heap.pop_back();
+        if (last == removed) return;
+
+        heap[i] = last;
+        last->slot = i;
+        try {
+            fix(i);
+        } catch (...) {
+            // pop_back nie zmniejszył pojemności, więc push_back nie rzuci
+            heap[last->slot] = removed;
+            removed->slot = last->slot;
+            heap.push_back(last);
+            last->slot = heap.size() - 1;
+            throw;
+        }
+    }
+
+    // Buduje kopiec od dołu [O(size())]; bez dziennika, więc przy wyjątku
+    // kolejność w tablicy jest dowolna (wołający odtwarza ją sam)
+    void heapify() {
+        if (heap.size() < 2) return;
+        for (size_type i = (heap.size() - 2) / D + 1; i-- > 0;)
+            sift_down(i, nullptr);
+    }
+
+    // Usuwa węzeł z kolejki [O(D * log_D size()) plus O(log size()) dla
+    // węzła z indeksu]; silna gwarancja
+    void remove(node* n) {
+        remove_slot(n->slot);
+        nodes.unindex(n);
+        nodes.destroy(n);
+    }
+
+    bool owns(handle h) const noexcept {
+        return h.target != nullptr && h.target->slot < heap.size() &&
+               heap[h.target->slot] == h.target;
+    }
+
+    void destroy_all() noexcept {
+        heap.clear();
+        nodes.destroy_all();
+    }
+
+    // Węzły posortowane po wartości, a potem po kluczu [O(size() *
+    // log size())]
+    scratch_vector<const node*> sorted_nodes() const {
+        scratch_vector<const node*> out(heap.begin(), heap.end(),
+                                        get_allocator());
+        std::sort(out.begin(), out.end(), ValueKeyComparer());
+        return out;
+    }
+
+   public:
+    // Konstruktor bezparametrowy tworzący pustą kolejkę [O(1)]
+    HeapQueue() : HeapQueue(Alloc()) {}
+
+    // Pusta kolejka korzystająca z alokatora alloc [O(1)]
+    explicit HeapQueue(const Alloc& alloc) : nodes(alloc), heap(alloc) {}
+
+    // Konstruktor kopiujący [O(queue.size())]
+    HeapQueue(const HeapQueue& queue)
+        : HeapQueue(queue,
+                    alloc_traits::select_on_container_copy_construction(
+                        queue.get_allocator())) {}
+
+    // Kopia queue w pamięci z alokatora alloc [O(queue.size())]; kopie
+    // zajmują te same pozycje w tablicy i czekają na pending
+    HeapQueue(const HeapQueue& queue, const Alloc& alloc)
+        : nodes(alloc), heap(queue.heap.size(), nullptr, alloc) {
+        try {
+            for (size_type i = 0; i < heap.size(); ++i) {
+                node* twin = nodes.create(queue.heap[i]->key,
+                                          queue.heap[i]->value);
+                twin->slot = i;
+                heap[i] = twin;
+                nodes.push_pending(twin);
+            }
+        } catch (...) {
+            nodes.destroy_all();
+            throw;
+        }
+    }
+
+    // Konstruktor przenoszący [O(1)]
+    HeapQueue(HeapQueue&& queue) noexcept
+        : HeapQueue(queue.get_allocator()) {
+        this->swap(queue);
+    }
+
+    // [O(size()), a dla trywialnie niszczalnych K i V O(liczba kawałków
+    // puli)]
+    ~HeapQueue() {
+        if (!std::is_trivially_destructible<node>::value) destroy_all();
+    }
+
+    // Operator przypisania [O(queue.size()) dla użycia P = Q, a O(1) dla użycia
+    // P = move(Q)]; alokator przechodzi tak jak w silniku drzewiastym
+    HeapQueue& operator=(const HeapQueue& queue) {
+        if (this == &queue) return *this;
+        HeapQueue tmp(
+            queue, alloc_traits::propagate_on_container_copy_assignment::value
+                       ? queue.get_allocator()
+                       : get_allocator());
+        this->swap(tmp);
+        return *this;
+    }
+
+    HeapQueue& operator=(HeapQueue&& queue) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value) {
+        if (this == &queue) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            get_allocator() == queue.get_allocator()) {
+            HeapQueue tmp(std::move(queue));
+            this->swap(tmp);
+        } else {
+            HeapQueue tmp(queue, get_allocator());
+            this->swap(tmp);
+        }
+        return *this;
+    }
+
+    // Kopia alokatora kolejki [O(1)]
+    Alloc get_allocator() const noexcept { return nodes.get_allocator(); }
+
+    // [O(1)]
+    bool empty() const noexcept { return heap.empty(); }
+    size_type size() const noexcept { return heap.size(); }
+
+    // Wstawienie pary [O(log_D size())]; zwraca uchwyt nowej pary. Silna
+    // gwarancja.
+    handle insert(const K& key, const V& value) {
+        node* n = nodes.create(key, value);
+        try {
+            heap.push_back(n);
+        } catch (...) {
+            nodes.destroy(n);
+            throw;
+        }
+        n->slot = heap.size() - 1;
+        try {
+            fix(n->slot);
+        } catch (...) {
+            heap.pop_back();
+            nodes.destroy(n);
+            throw;
+        }
+        nodes.push_pending(n);
+        return handle(n);
+    }
+
+    // Najmniejsza wartość i jej klucz [O(1)]
+    const V& minValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return heap[0]->value;
+    }
+    const K& minKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return heap[0]->key;
+    }
+
+    // Para wskazywana przez ważny uchwyt [O(1)]
+    const K& key(handle h) const {
+        assert(owns(h) && "DaryHeapBackend: foreign or stale handle");
+        return h.target->key;
+    }
+    const V& value(handle h) const {
+        assert(owns(h) && "DaryHeapBackend: foreign or stale handle");
+        return h.target->value;
+    }
+
+    // Kopiec nie zna maksimum
+    const V& maxValue() const = delete;
+    const K& maxKey() const = delete;
+    void deleteMax() = delete;
+
+    // Usunięcie pary o najmniejszej wartości [O(D * log_D size()) plus
+    // O(log size()) dla pary z indeksu]; silna gwarancja
+    void deleteMin() {
+        if (empty()) return;
+        remove(heap[0]);
+    }
+
+    // Usunięcie pary wskazywanej przez ważny uchwyt [O(D * log_D size())
+    // plus O(log size()) dla pary z indeksu], bez wyszukiwania klucza;
+    // silna gwarancja
+    void erase(handle h) {
+        assert(owns(h) && "DaryHeapBackend: foreign or stale handle");
+        remove(h.target);
+    }
+
+    // Zmiana wartości w parze wskazywanej przez ważny uchwyt
+    // [O(D * log_D size()) plus O(log size()) dla pary z indeksu], bez
+    // wyszukiwania klucza; zwraca uchwyt zmienionej pary, a stary traci
+    // ważność. Nowy węzeł (z kopią klucza i nową wartością) zajmuje pozycję
+    // starego i dopiero po udanej naprawie kopca stary węzeł jest usuwany -
+    // silna gwarancja.
+    handle changeValue(handle h, const V& value) {
+        assert(owns(h) && "DaryHeapBackend: foreign or stale handle");
+        node* old = h.target;
+        node* n = nodes.create(old->key, value);
+        size_type i = old->slot;
+        heap[i] = n;
+        n->slot = i;
+        try {
+            fix(i);
+        } catch (...) {
+            // fix cofnął zamiany, więc n jest z powrotem na pozycji i
+            heap[i] = old;
+            nodes.destroy(n);
+            throw;
+        }
+
+        // Od tego miejsca nic nie rzuca
+        nodes.unindex(old);
+        nodes.destroy(old);
+        nodes.push_pending(n);
+        return handle(n);
+    }
+
+    // Zmiana wartości w dowolnej parze o kluczu key [O(D * log_D size())
+    // plus O(p * log size()) za p par wstawionych od poprzedniego
+    // wyszukiwania]; silna gwarancja jak dla uchwytu
+    void changeValue(const K& key, const V& value) {
+        nodes.flush();
+        node* n = nodes.find(key);
+        if (n == nullptr) throw PriorityQueueNotFoundException();
+        changeValue(handle(n), value);
+    }
+
+    // Scalenie z queue [O(size() + queue.size())]: dokładamy węzły queue na
+    // koniec tablicy i budujemy kopiec od dołu. Węzły są przepinane, więc
+    // uchwyty par z queue pozostają ważne w *this (przy różnych alokatorach
+    // scalamy kopię queue i uchwyty queue tracą ważność).
+    void merge(HeapQueue& queue) {
+        if (this == &queue || queue.empty()) return;
+        if (!(get_allocator() == queue.get_allocator())) {
+            HeapQueue copy(queue, get_allocator());
+            HeapQueue emptied(queue.get_allocator());
+            merge(copy);
+            queue.swap(emptied);
+            return;
+        }
+        if (empty()) {
+            this->swap(queue);
+            return;
+        }
+
+        scratch_vector<node*> merged(get_allocator());
+        merged.reserve(heap.size() + queue.heap.size());
+        merged = heap;
+        merged.insert(merged.end(), queue.heap.begin(), queue.heap.end());
+
+        // Budowa kopca na nowej tablicy; jeśli porównanie rzuci, wracamy do
+        // starych tablic i poprawiamy pozycje węzłów
+        heap.swap(merged);
+        for (size_type i = 0; i < heap.size(); ++i) heap[i]->slot = i;
+        try {
+            heapify();
+        } catch (...) {
+            heap.swap(merged);
+            for (size_type i = 0; i < heap.size(); ++i) heap[i]->slot = i;
+            for (size_type i = 0; i < queue.heap.size(); ++i)
+                queue.heap[i]->slot = i;
+            throw;
+        }
+
+        // Od tego miejsca nic nie rzuca
+        nodes.splice(queue.nodes);
+        queue.heap.clear();
+    }
+
+    // [O(1)], gwarancja no-throw; alokatory jak w silniku drzewiastym
+    void swap(HeapQueue& queue) noexcept {
+        if (this == &queue) return;
+        nodes.swap(queue.nodes);
+        heap.swap(queue.heap);
+    }
+
+    friend void swap(HeapQueue& lhs, HeapQueue& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    // Porównania [O(size() * log size())] - węzły trzeba najpierw
+    // posortować
+    friend bool operator==(const HeapQueue& lhs, const HeapQueue& rhs) {
+        using priority_queue_detail::compare_equal;
+        if (lhs.size() != rhs.size()) return false;
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        for (size_type i = 0; i < a.size(); ++i)
+            if (!compare_equal(a[i]->key, b[i]->key) ||
+                !compare_equal(a[i]->value, b[i]->value))
+                return false;
+        return true;
+    }
+    friend bool operator!=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const HeapQueue& lhs, const HeapQueue& rhs) {
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(),
+                                            b.end(), ValueKeyComparer());
+    }
+    friend bool operator>(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs > rhs);
+    }
+    friend bool operator>=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs < rhs);
+    }
+};
+
+#endif /* end of include guard: _JNP1_DARYHEAP_HH_ */
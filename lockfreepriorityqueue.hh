@@ -0,0 +1,571 @@
+#ifndef _JNP1_LOCKFREEPRIORITYQUEUE_HH_
+#define _JNP1_LOCKFREEPRIORITYQUEUE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+class PriorityQueueThreadLimitException : public std::exception {
+   public:
+    PriorityQueueThreadLimitException() = default;
+    virtual const char* what() const noexcept(true) {
+        return "Too many threads use the lock-free priority queue.";
+    }
+};
+
+namespace priority_queue_detail {
+
+// Część domeny epok, której potrzebuje kończący się wątek; może przeżyć
+// samą domenę, dopóki wątek oddaje slot
+class epoch_state_base {
+   public:
+    virtual ~epoch_state_base() = default;
+    // Zwalnia slot index wątku, który się kończy
+    virtual void release(unsigned index) noexcept = 0;
+};
+
+// Sloty zajęte przez bieżący wątek w kolejnych domenach. Przy końcu wątku
+// oddaje je domenom, które jeszcze istnieją.
+class epoch_thread {
+   public:
+    struct entry {
+        std::uint64_t domain;
+        std::weak_ptr<epoch_state_base> state;
+        unsigned index;
+    };
+
+    static epoch_thread& current() {
+        static thread_local epoch_thread self;
+        return self;
+    }
+
+    ~epoch_thread() {
+        for (entry& e : entries)
+            if (std::shared_ptr<epoch_state_base> s = e.state.lock())
+                s->release(e.index);
+    }
+
+    // Wpis domeny o identyfikatorze domain albo nullptr
+    const entry* find(std::uint64_t domain) noexcept {
+        if (last < entries.size() && entries[last].domain == domain)
+            return &entries[last];
+        for (std::size_t i = 0; i < entries.size(); ++i)
+            if (entries[i].domain == domain) {
+                last = i;
+                return &entries[i];
+            }
+        return nullptr;
+    }
+
+    void add(std::uint64_t domain, std::weak_ptr<epoch_state_base> state,
+             unsigned index) {
+        // wpisy domen, których już nie ma
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const entry& e) {
+                                         return e.state.expired();
+                                     }),
+                      entries.end());
+        entries.push_back(entry{domain, std::move(state), index});
+        last = entries.size() - 1;
+    }
+
+   protected:
+    std::vector<entry> entries;
+    // ostatnio używany wpis - wątek zwykle pracuje z jedną kolejką naraz
+    std::size_t last = 0;
+};
+
+// Odzyskiwanie pamięci oparte na epokach. Wątek przed dotknięciem wspólnej
+// struktury ogłasza w swoim slocie bieżącą epokę globalną, a po skończeniu
+// operacji ją czyści. Odłączony węzeł trafia na listę slotu razem z epoką
+// z chwili odłączenia i jest zwalniany, gdy epoka globalna urośnie o 2 -
+// wtedy żaden wątek, który mógł go jeszcze widzieć, nie jest w środku
+// operacji. Epoka rośnie, gdy wszystkie aktywne wątki ją już widziały.
+//
+// Wątek zajmuje slot przy pierwszej operacji i oddaje go, gdy się kończy;
+// jego nie zwolnione jeszcze węzły przechodzą wtedy na wspólną listę domeny.
+template <typename Node>
+class epoch_domain {
+   public:
+    using retired = std::pair<std::uint64_t, Node*>;
+
+    struct slot {
+        std::atomic<bool> used{false};
+        // 0 - wątek poza operacją
+        std::atomic<std::uint64_t> epoch{0};
+        // odłączone węzły z epokami; dostępne tylko dla właściciela slotu
+        std::vector<retired> limbo;
+    };
+
+    // Sekcja krytyczna wątku (RAII)
+    class guard {
+        epoch_domain& domain;
+
+       public:
+        slot& own;
+
+        explicit guard(epoch_domain& domain)
+            : domain(domain), own(domain.own_slot()) {
+            own.epoch.store(domain.shared->global.load());
+        }
+        ~guard() { own.epoch.store(0); }
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+
+        void retire(Node* n) { domain.retire(own, n); }
+    };
+
+    explicit epoch_domain(unsigned max_threads)
+        : shared(std::make_shared<state>(max_threads)),
+          id(next_id().fetch_add(1)) {}
+
+   protected:
+    // Po tylu odłożonych węzłach próbujemy przesunąć epokę i zwolnić pamięć
+    static const std::size_t collect_threshold = 64;
+
+    struct state : epoch_state_base {
+        std::unique_ptr<slot[]> slots;
+        unsigned slot_count;
+        std::atomic<std::uint64_t> global{1};
+        // węzły po wątkach, które się skończyły
+        std::mutex orphans_lock;
+        std::vector<retired> orphans;
+        std::atomic<std::size_t> orphan_count{0};
+
+        explicit state(unsigned max_threads)
+            : slots(new slot[max_threads]), slot_count(max_threads) {}
+
+        // Zwalnia wszystko, co czeka; stan znika dopiero wtedy, gdy nie
+        // używa go ani domena, ani kończący się wątek
+        ~state() {
+            for (unsigned i = 0; i < slot_count; ++i)
+                for (const retired& r : slots[i].limbo) delete r.second;
+            for (const retired& r : orphans) delete r.second;
+        }
+
+        void release(unsigned index) noexcept override {
+            slot& s = slots[index];
+            {
+                std::lock_guard<std::mutex> guard(orphans_lock);
+                try {
+                    orphans.insert(orphans.end(), s.limbo.begin(),
+                                   s.limbo.end());
+                } catch (...) {
+                    // bez pamięci slot zostaje zajęty, a jego węzły zwolni
+                    // destruktor
+                    return;
+                }
+                orphan_count.store(orphans.size());
+            }
+            s.limbo.clear();
+            s.used.store(false);
+        }
+    };
+
+    std::shared_ptr<state> shared;
+    // identyfikator domeny dla wpisów wątku - adres mógłby zostać użyty
+    // ponownie przez nową kolejkę
+    std::uint64_t id;
+
+    static std::atomic<std::uint64_t>& next_id() {
+        static std::atomic<std::uint64_t> counter{1};
+        return counter;
+    }
+
+    slot& own_slot() {
+        state& st = *shared;
+        epoch_thread& me = epoch_thread::current();
+        if (const epoch_thread::entry* e = me.find(id))
+            return st.slots[e->index];
+
+        for (unsigned i = 0; i < st.slot_count; ++i) {
+            bool expected = false;
+            if (st.slots[i].used.compare_exchange_strong(expected, true)) {
+                try {
+                    me.add(id, shared, i);
+                } catch (...) {
+                    st.slots[i].used.store(false);
+                    throw;
+                }
+                return st.slots[i];
+            }
+        }
+        throw PriorityQueueThreadLimitException();
+    }
+
+    // Zwalnia węzły z listy, które odłożono co najmniej dwie epoki przed e
+    static void collect(std::vector<retired>& list, std::uint64_t e) {
+        std::size_t kept = 0;
+        for (const retired& r : list) {
+            if (r.first + 2 <= e)
+                delete r.second;
+            else
+                list[kept++] = r;
+        }
+        list.resize(kept);
+    }
+
+    void retire(slot& own, Node* n) {
+        state& st = *shared;
+        own.limbo.emplace_back(st.global.load(), n);
+        if (own.limbo.size() < collect_threshold) return;
+
+        std::uint64_t e = st.global.load();
+        bool everyone_seen = true;
+        for (unsigned i = 0; i < st.slot_count && everyone_seen; ++i) {
+            std::uint64_t seen = st.slots[i].epoch.load();
+            if (seen != 0 && seen != e) everyone_seen = false;
+        }
+        if (everyone_seen) st.global.compare_exchange_strong(e, e + 1);
+
+        e = st.global.load();
+        collect(own.limbo, e);
+        if (st.orphan_count.load() != 0) {
+            std::unique_lock<std::mutex> guard(st.orphans_lock,
+                                               std::try_to_lock);
+            if (guard.owns_lock()) {
+                collect(st.orphans, e);
+                st.orphan_count.store(st.orphans.size());
+            }
+        }
+    }
+};
+
+}  // namespace priority_queue_detail
+
+// Nieblokująca kolejka priorytetowa na liście z przeskokami (Lindén,
+// Jonsson: "A Skiplist-Based Concurrent Priority Queue with Minimal Memory
+// Contention"), uporządkowanej po (wartość, klucz).
+//
+// deleteMin usuwa logicznie następnik węzła, ustawiając bit w jego
+// wskaźniku next[0] przez fetch_or, więc usunięte węzły tworzą prefiks listy.
+// Fizycznie odcinamy ten prefiks dopiero wtedy, gdy jest dłuższy niż
+// bound_offset - jednym CAS-em na głowie listy - a odcięte węzły oddajemy
+// epokom. Dzięki temu wątki rzadko piszą w to samo miejsce.
+//
+// Kolejka nie ma deleteMax. Węzeł zdjęty z końca listy zostawałby w niej,
+// dopóki nie dojdzie do niego prefiks usuniętych, więc przy przewadze
+// deleteMax lista rosłaby bez ograniczenia, a każde kolejne deleteMax
+// przechodziłoby przez wszystkie martwe węzły. Wycięcie węzła ze środka
+// wymagałoby zamrażania wskaźników (Harris, Fraser), co kłóci się
+// z przesuwaniem głowy w restructure. maxValue / maxKey tylko czytają.
+//
+// Metody mają te same nazwy co w PriorityQueue (bez deleteMax, changeValue
+// i merge), zwracają kopie, a popMin zwraca usuniętą parę. Porównania
+// kluczy i wartości, które rzucą przed wstawieniem węzła do listy, nie
+// zmieniają kolejki; jeśli pary nie da się skopiować w popMin, jest już
+// usunięta.
+template <typename K, typename V>
+class LockFreePriorityQueue {
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+
+   protected:
+    static const int max_level = 32;
+    static const size_type bound_offset = 32;
+
+    // Część węzła wspólna z głową listy (głowa nie ma klucza ani wartości)
+    struct links {
+        int level;
+        // zajęty przez deleteMin
+        std::atomic<bool> taken{false};
+        // wyższe poziomy są jeszcze dowiązywane
+        std::atomic<bool> inserting{false};
+        // najmłodszy bit wskaźnika next[0] oznacza, że następnik jest usunięty
+        std::unique_ptr<std::atomic<std::uintptr_t>[]> next;
+
+        explicit links(int level)
+            : level(level), next(new std::atomic<std::uintptr_t>[level]) {
+            for (int i = 0; i < level; ++i) next[i].store(0);
+        }
+    };
+
+    struct node : links {
+        K key;
+        V value;
+
+        node(const K& key, const V& value, int level)
+            : links(level), key(key), value(value) {}
+    };
+
+    using domain_type = priority_queue_detail::epoch_domain<node>;
+
+    static bool is_marked(std::uintptr_t p) noexcept { return p & 1; }
+    static links* unmarked(std::uintptr_t p) noexcept {
+        return reinterpret_cast<links*>(p & ~std::uintptr_t(1));
+    }
+    static std::uintptr_t pointer(links* n) noexcept {
+        return reinterpret_cast<std::uintptr_t>(n);
+    }
+    // Każdy węzeł poza głową jest node
+    static node* as_node(links* n) noexcept { return static_cast<node*>(n); }
+
+    // porządek (wartość, klucz)
+    static bool less(const node& lhs, const node& rhs) {
+        using priority_queue_detail::compare_less;
+        if (compare_less(lhs.value, rhs.value)) return true;
+        if (compare_less(rhs.value, lhs.value)) return false;
+        return compare_less(lhs.key, rhs.key);
+    }
+
+    mutable domain_type epochs;
+    links head;
+    std::atomic<size_type> total{0};
+
+    // Poziom nowego węzła - rozkład geometryczny z p = 1/2
+    static int random_level() {
+        static thread_local std::uint32_t state = 0;
+        if (state == 0) {
+            state = 2463534242u ^
+                    static_cast<std::uint32_t>(std::hash<std::thread::id>()(
+                        std::this_thread::get_id()));
+            if (state == 0) state = 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        int level = 1;
+        for (std::uint32_t r = state; (r & 1) && level < max_level; r >>= 1)
+            ++level;
+        return level;
+    }
+
+    static bool cas(std::atomic<std::uintptr_t>& target, links* expected,
+                    links* desired) {
+        std::uintptr_t e = pointer(expected);
+        return target.compare_exchange_strong(e, pointer(desired));
+    }
+
+    // Dla każdego poziomu szuka ostatniego węzła przed n (preds) i jego
+    // następnika (succs), pomijając usunięte węzły; na poziomie 0 preds[0]
+    // może być co najwyżej ostatnim usuniętym węzłem. Zwraca ostatni usunięty
+    // węzeł, przez który przeszliśmy na poziomie 0.
+    links* locate_preds(const node& n, links** preds, links** succs) {
+        links* x = &head;
+        links* del = nullptr;
+        for (int i = max_level - 1; i >= 0; --i) {
+            std::uintptr_t raw = x->next[i].load();
+            bool d = is_marked(raw);
+            links* cur = unmarked(raw);
+            while (cur != nullptr &&
+                   (less(*as_node(cur), n) || is_marked(cur->next[0].load()) ||
+                    (i == 0 && d))) {
+                if (d && i == 0) del = cur;
+                x = cur;
+                raw = x->next[i].load();
+                d = is_marked(raw);
+                cur = unmarked(raw);
+            }
+            preds[i] = x;
+            succs[i] = cur;
+        }
+        return del;
+    }
+
+    // Przesuwa wskaźniki głowy na wyższych poziomach za usunięte węzły
+    void restructure() {
+        links* pred = &head;
+        for (int i = max_level - 1; i > 0;) {
+            std::uintptr_t h = head.next[i].load();
+            links* first = unmarked(h);
+            if (first == nullptr || !is_marked(first->next[0].load())) {
+                --i;
+                continue;
+            }
+            links* cur = unmarked(pred->next[i].load());
+            while (cur != nullptr && is_marked(cur->next[0].load())) {
+                pred = cur;
+                cur = unmarked(pred->next[i].load());
+            }
+            if (head.next[i].compare_exchange_strong(h, pointer(cur))) --i;
+        }
+    }
+
+    // Zajmuje najmniejszy wolny węzeł i zwraca go (albo nullptr, gdy kolejka
+    // jest pusta); wywoływać w sekcji krytycznej g
+    node* claim_min(typename domain_type::guard& g) {
+        links* x = &head;
+        links* newhead = nullptr;
+        size_type offset = 0;
+        std::uintptr_t obs_head = head.next[0].load();
+        while (true) {
+            std::uintptr_t nxt = x->next[0].load();
+            if (unmarked(nxt) == nullptr) return nullptr;
+            if (newhead == nullptr && x->inserting.load()) newhead = x;
+            // jeśli następnik nie jest jeszcze usunięty, usuwamy go my
+            if (!is_marked(nxt)) nxt = x->next[0].fetch_or(1);
+            ++offset;
+            links* s = unmarked(nxt);
+            bool ours = !is_marked(nxt) && !s->taken.exchange(true);
+            x = s;
+            if (ours) break;
+        }
+
+        if (newhead == nullptr) newhead = x;
+        if (offset > bound_offset &&
+            head.next[0].compare_exchange_strong(obs_head,
+                                                 pointer(newhead) | 1)) {
+            restructure();
+            links* cur = unmarked(obs_head);
+            while (cur != newhead) {
+                links* following = unmarked(cur->next[0].load());
+                g.retire(as_node(cur));
+                cur = following;
+            }
+        }
+        return as_node(x);
+    }
+
+    // Ostatni wolny węzeł albo nullptr. Schodzimy w stronę ostatniego węzła
+    // mniejszego od bound, ale zatrzymujemy się na poziomie back, i od tego
+    // miejsca przeglądamy poziom 0 aż do bound (to obejmuje węzły równe
+    // bound). Jeśli wszystkie są zajęte, cofamy bound i podnosimy poziom,
+    // więc k zajętych węzłów na końcu listy kosztuje O(k + log k log size()).
+    node* find_max() {
+        links* bound = nullptr;
+        for (int back = 0;; back += back < max_level - 1 ? 1 : 0) {
+            links* x = &head;
+            for (int i = max_level - 1; i >= back; --i) {
+                links* cur = unmarked(x->next[i].load());
+                while (cur != nullptr && cur != bound &&
+                       (bound == nullptr ||
+                        less(*as_node(cur), *as_node(bound)))) {
+                    x = cur;
+                    cur = unmarked(x->next[i].load());
+                }
+            }
+            links* best =
+                x != &head && !x->taken.load() ? x : nullptr;
+            for (links* n = unmarked(x->next[0].load());
+                 n != nullptr && n != bound; n = unmarked(n->next[0].load()))
+                if (!n->taken.load()) best = n;
+            if (best != nullptr) return as_node(best);
+            if (x == &head) return nullptr;
+            bound = x;
+        }
+    }
+
+    node* find_min() {
+        for (links* n = unmarked(head.next[0].load()); n != nullptr;
+             n = unmarked(n->next[0].load()))
+            if (!n->taken.load()) return as_node(n);
+        return nullptr;
+    }
+
+    std::pair<K, V> extreme(bool max) {
+        typename domain_type::guard g(epochs);
+        node* n = max ? find_max() : find_min();
+        if (n == nullptr) throw PriorityQueueEmptyException();
+        return std::pair<K, V>(n->key, n->value);
+    }
+
+   public:
+    // Kolejka dla co najwyżej max_threads wątków używających jej naraz;
+    // slot wątku zwalnia się, gdy wątek się kończy
+    explicit LockFreePriorityQueue(unsigned max_threads = 128)
+        : epochs(max_threads), head(max_level) {}
+
+    LockFreePriorityQueue(const LockFreePriorityQueue&) = delete;
+    LockFreePriorityQueue& operator=(const LockFreePriorityQueue&) = delete;
+
+    // Wywoływać, gdy żaden wątek nie używa już kolejki; węzły odcięte
+    // wcześniej zwalnia domena epok
+    ~LockFreePriorityQueue() {
+        links* n = unmarked(head.next[0].load());
+        while (n != nullptr) {
+            links* following = unmarked(n->next[0].load());
+            delete as_node(n);
+            n = following;
+        }
+    }
+
+    // [O(1)]; w trakcie równoległych operacji wynik może być już nieaktualny
+    bool empty() const noexcept { return total.load() == 0; }
+    size_type size() const noexcept { return total.load(); }
+
+    // Wstawienie pary [O(log size()) oczekiwanie]
+    void insert(const K& key, const V& value) {
+        typename domain_type::guard g(epochs);
+        int height = random_level();
+        node* n = new node(key, value, height);
+        n->inserting.store(true);
+        links* preds[max_level];
+        links* succs[max_level];
+        links* del;
+        try {
+            do {
+                del = locate_preds(*n, preds, succs);
+                n->next[0].store(pointer(succs[0]));
+            } while (!cas(preds[0]->next[0], succs[0], n));
+        } catch (...) {
+            delete n;
+            throw;
+        }
+        ++total;
+
+        // Para już jest w liście; jeśli porównanie rzuci, zostawiamy węzeł
+        // z mniejszą liczbą poziomów
+        try {
+            for (int i = 1; i < height;) {
+                n->next[i].store(pointer(succs[i]));
+                if (is_marked(n->next[0].load()) ||
+                    (succs[i] != nullptr &&
+                     is_marked(succs[i]->next[0].load())) ||
+                    (del != nullptr && del == succs[i]))
+                    break;
+                if (cas(preds[i]->next[i], succs[i], n)) {
+                    ++i;
+                } else {
+                    del = locate_preds(*n, preds, succs);
+                    if (succs[0] != n) break;
+                }
+            }
+        } catch (...) {
+        }
+        n->inserting.store(false);
+    }
+
+    // Usuwa parę o najmniejszej wartości i zwraca ją w key i value
+    // [O(log size()) oczekiwanie]; false, gdy kolejka jest pusta
+    bool popMin(K& key, V& value) {
+        typename domain_type::guard g(epochs);
+        node* n = claim_min(g);
+        if (n == nullptr) return false;
+        --total;
+        key = n->key;
+        value = n->value;
+        return true;
+    }
+
+    void deleteMin() {
+        typename domain_type::guard g(epochs);
+        if (claim_min(g) != nullptr) --total;
+    }
+
+    // Kopie skrajnych par; PriorityQueueEmptyException, gdy kolejka jest
+    // pusta
+    V minValue() const { return mutable_this().extreme(false).second; }
+    K minKey() const { return mutable_this().extreme(false).first; }
+    V maxValue() const { return mutable_this().extreme(true).second; }
+    K maxKey() const { return mutable_this().extreme(true).first; }
+
+   protected:
+    // Odczyty też wchodzą do sekcji krytycznej i chodzą po wskaźnikach
+    // atomowych, więc wewnętrznie nie są const
+    LockFreePriorityQueue& mutable_this() const {
+        return const_cast<LockFreePriorityQueue&>(*this);
+    }
+};
+
+#endif /* end of include guard: _JNP1_LOCKFREEPRIORITYQUEUE_HH_ */
@@ -0,0 +1,604 @@
+#ifndef _JNP1_MINMAXHEAP_HH_
+#define _JNP1_MINMAXHEAP_HH_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+// Silnik oparty na kopcu min-max trzymanym w tablicy: minValue, maxValue,
+// minKey i maxKey w O(1), insert, deleteMin, deleteMax i changeValue
+// w O(log size()). W tablicy są wskaźniki na węzły z puli, a każdy węzeł pamięta
+// swoją pozycję (slot) i jest podpięty do drzewa po (kluczu, wartości), które
+// służy changeValue i pilnuje, żeby każda para była trzymana raz.
+struct MinMaxHeapBackend {};
+
+template <typename K, typename V, typename Alloc>
+class PriorityQueue<K, V, MinMaxHeapBackend, Alloc> {
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+
+   protected:
+    struct node {
+        priority_queue_detail::tree_hook<node> by_key;
+        unsigned priority;
+        // pozycja w tablicy heap
+        size_type slot;
+        size_type count;
+        K key;
+        V value;
+
+        node(const K& key, const V& value, unsigned priority)
+            : priority(priority), slot(0), count(1), key(key), value(value) {}
+    };
+
+    struct element_ref {
+        const K& key;
+        const V& value;
+    };
+
+    static const K& key_of(const node& n) noexcept { return n.key; }
+    static const K& key_of(const element_ref& e) noexcept { return e.key; }
+    static const K& key_of(const K& key) noexcept { return key; }
+    static const V& value_of(const node& n) noexcept { return n.value; }
+    static const V& value_of(const element_ref& e) noexcept { return e.value; }
+
+    // Komparatory
+    class KeyComparer {
+       public:
+        using is_transparent = void;
+
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const {
+            return priority_queue_detail::compare_less(key_of(lhs),
+                                                       key_of(rhs));
+        }
+    };
+
+    class KeyValueComparer {
+       public:
+        using is_transparent = void;
+
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const {
+            using priority_queue_detail::compare_less;
+            if (compare_less(key_of(lhs), key_of(rhs))) return true;
+            if (compare_less(key_of(rhs), key_of(lhs))) return false;
+            return compare_less(value_of(lhs), value_of(rhs));
+        }
+    };
+
+    class ValueKeyComparer {
+       public:
+        bool operator()(const node* lhs, const node* rhs) const {
+            using priority_queue_detail::compare_less;
+            if (compare_less(lhs->value, rhs->value)) return true;
+            if (compare_less(rhs->value, lhs->value)) return false;
+            return compare_less(lhs->key, rhs->key);
+        }
+    };
+
+    // Dziennik zamian jednej naprawy kopca; naprawa w górę i w dół robi
+    // łącznie mniej niż 2 * 64 zamian
+    using swap_journal = priority_queue_detail::swap_journal<2 * 64 + 4>;
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    template <typename T>
+    using scratch_vector = priority_queue_detail::scratch_vector<T, Alloc>;
+
+    using slab_type = priority_queue_detail::node_slab<node, Alloc>;
+    using key_index = priority_queue_detail::treap<node, &node::by_key>;
+
+    // pamięć na węzły
+    slab_type slab;
+    // kopiec min-max: poziomy parzyste (licząc od 0) są poziomami minimów,
+    // nieparzyste - maksimów
+    scratch_vector<node*> heap;
+    // sortowanie po kluczu, a potem po wartości
+    key_index sorted_by_key;
+    // liczba par razem z powtórzeniami
+    size_type total = 0;
+    unsigned seed = 2463534242u;
+
+   protected:
+    unsigned next_priority() noexcept {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    node* create_node(const K& key, const V& value) {
+        void* p = slab.allocate();
+        try {
+            return new (p) node(key, value, next_priority());
+        } catch (...) {
+            slab.deallocate(p);
+            throw;
+        }
+    }
+
+    void destroy_node(node* n) noexcept {
+        n->~node();
+        slab.deallocate(n);
+    }
+
+    void destroy_all() noexcept {
+        for (node* n : heap) destroy_node(n);
+        heap.clear();
+        sorted_by_key.clear();
+        total = 0;
+    }
+
+    // Szuka węzła z parą równoważną probe; jeśli go nie ma, ustawia
+    // parent/left na miejsce w sorted_by_key [O(log size())]
+    template <typename Probe>
+    node* find_pair(const Probe& probe, node*& parent, bool& left) const {
+        KeyValueComparer less;
+        node* n = sorted_by_key.root;
+        parent = nullptr;
+        left = false;
+        while (n != nullptr) {
+            if (less(probe, *n)) {
+                parent = n;
+                left = true;
+                n = n->by_key.left;
+            } else if (less(*n, probe)) {
+                parent = n;
+                left = false;
+                n = n->by_key.right;
+            } else {
+                return n;
+            }
+        }
+        return nullptr;
+    }
+
+    // Operacje na tablicy kopca. Porównania mogą rzucić; wszystkie zamiany
+    // trafiają do dziennika (o ile jest podany), żeby dało się je cofnąć.
+
+    static bool min_level(size_type i) noexcept {
+        unsigned level = 0;
+        for (size_type x = i + 1; x > 1; x /= 2) ++level;
+        return level % 2 == 0;
+    }
+
+    bool less(size_type i, size_type j) const {
+        return priority_queue_detail::compare_less(heap[i]->value,
+                                                   heap[j]->value);
+    }
+
+    void swap_slots(size_type i, size_type j, swap_journal* journal) noexcept {
+        if (journal != nullptr)
+            journal->swap(heap, i, j);
+        else
+            swap_journal::swap_slots(heap, i, j);
+    }
+
+    // Przesuwa element z pozycji i w górę po dziadkach (w kopcu minimów
+    // albo maksimów)
+    void bubble_up_grandparents(size_type i, bool max, swap_journal* journal) {
+        while (i > 2) {
+            size_type g = ((i - 1) / 2 - 1) / 2;
+            if (!(max ? less(g, i) : less(i, g))) return;
+            swap_slots(i, g, journal);
+            i = g;
+        }
+    }
+
+    void bubble_up(size_type i, swap_journal* journal) {
+        if (i == 0) return;
+        size_type p = (i - 1) / 2;
+        bool on_min = min_level(i);
+        if (on_min ? less(p, i) : less(i, p)) {
+            swap_slots(i, p, journal);
+            bubble_up_grandparents(p, on_min, journal);
+        } else {
+            bubble_up_grandparents(i, !on_min, journal);
+        }
+    }
+
+    void trickle_down(size_type i, swap_journal* journal) {
+        bool on_min = min_level(i);
+        size_type n = heap.size();
+        while (true) {
+            size_type c = 2 * i + 1;
+            if (c >= n) return;
+            // najlepszy spośród dzieci i wnuków
+            size_type m = c;
+            size_type candidates[] = {c + 1, 4 * i + 3, 4 * i + 4, 4 * i + 5,
+                                      4 * i + 6};
+            for (size_type k : candidates)
+                if (k < n && (on_min ? less(k, m) : less(m, k))) m = k;
+
+            if (!(on_min ? less(m, i) : less(i, m))) return;
+            swap_slots(i, m, journal);
+            if (m < 4 * i + 3) return;
+
+            size_type p = (m - 1) / 2;
+            if (on_min ? less(p, m) : less(m, p)) swap_slots(m, p, journal);
+            i = m;
+        }
+    }
+
+    // Przywraca własność kopca po wstawieniu nowego elementu na pozycję i
+    // [O(log size())]; jeśli porównanie rzuci, tablica wraca do stanu
+    // sprzed naprawy
+    void fix(size_type i) {
+        swap_journal journal;
+        try {
+            bubble_up(i, &journal);
+            trickle_down(i, &journal);
+        } catch (...) {
+            journal.undo(heap);
+            throw;
+        }
+    }
+
+    // Wyjmuje z tablicy węzeł z pozycji i (na jego miejsce trafia ostatni)
+    // [O(log size())]; silna gwarancja
+    void remove_slot(size_type i) {
+        node* removed = heap[i];
+        node* last = heap.back();
+        heap.pop_back();
+        if (last == removed) return;
+
+        heap[i] = last;
+        last->slot = i;
+        try {
+            fix(i);
+        } catch (...) {
+            // pop_back nie zmniejszył pojemności, więc push_back nie rzuci
+            heap[last->slot] = removed;
+            removed->slot = last->slot;
+            heap.push_back(last);
+            last->slot = heap.size() - 1;
+            throw;
+        }
+    }
+
+    size_type max_slot() const {
+        if (heap.size() <= 2) return heap.size() - 1;
+        return less(1, 2) ? 2 : 1;
+    }
+
+    // Usuwa jedno powtórzenie pary z węzła n [O(log size())]
+    void remove_one(node* n) {
+        if (n->count > 1) {
+            --n->count;
+        } else {
+            remove_slot(n->slot);
+            sorted_by_key.unlink(n);
+            destroy_node(n);
+        }
+        --total;
+    }
+
+   public:
+    // Konstruktor bezparametrowy tworzący pustą kolejkę [O(1)]
+    PriorityQueue() : PriorityQueue(Alloc()) {}
+
+    // Pusta kolejka korzystająca z alokatora alloc [O(1)]
+    explicit PriorityQueue(const Alloc& alloc) : slab(alloc), heap(alloc) {}
+
+    // Konstruktor kopiujący [O(queue.size())]
+    PriorityQueue(const PriorityQueue& queue)
+        : PriorityQueue(queue,
+                        alloc_traits::select_on_container_copy_construction(
+                            queue.get_allocator())) {}
+
+    // Kopia queue w pamięci z alokatora alloc [O(queue.size())]
+    // Węzły kopiujemy w kolejności drzewa po kluczu, a kopie trafiają na te
+    // same pozycje w tablicy, więc kształt obu struktur się nie zmienia
+    PriorityQueue(const PriorityQueue& queue, const Alloc& alloc)
+        : slab(alloc), heap(queue.heap.size(), nullptr, alloc),
+          total(queue.total) {
+        scratch_vector<node*> in_order(alloc);
+        try {
+            in_order.reserve(queue.heap.size());
+            for (node* n = queue.sorted_by_key.first; n != nullptr;
+                 n = key_index::next(n)) {
+                node* twin = create_node(n->key, n->value);
+                twin->priority = n->priority;
+                twin->slot = n->slot;
+                twin->count = n->count;
+                heap[n->slot] = twin;
+                in_order.push_back(twin);
+            }
+        } catch (...) {
+            for (node* n : heap)
+                if (n != nullptr) destroy_node(n);
+            throw;
+        }
+        sorted_by_key.build(in_order.begin(), in_order.end());
+    }
+
+    // Konstruktor przenoszący [O(1)]
+    PriorityQueue(PriorityQueue&& queue) noexcept
+        : PriorityQueue(queue.get_allocator()) {
+        this->swap(queue);
+    }
+
+    // [O(size()), a dla trywialnie niszczalnych K i V O(liczba kawałków
+    // puli)]
+    ~PriorityQueue() {
+        if (!std::is_trivially_destructible<node>::value) destroy_all();
+    }
+
+    // Operator przypisania [O(queue.size()) dla użycia P = Q, a O(1) dla użycia
+    // P = move(Q)]; alokator przechodzi tak jak w silniku drzewiastym
+    PriorityQueue& operator=(const PriorityQueue& queue) {
+        if (this == &queue) return *this;
+        PriorityQueue tmp(
+            queue, alloc_traits::propagate_on_container_copy_assignment::value
+                       ? queue.get_allocator()
+                       : get_allocator());
+        this->swap(tmp);
+        return *this;
+    }
+
+    PriorityQueue& operator=(PriorityQueue&& queue) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value) {
+        if (this == &queue) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            get_allocator() == queue.get_allocator()) {
+            PriorityQueue tmp(std::move(queue));
+            this->swap(tmp);
+        } else {
+            PriorityQueue tmp(queue, get_allocator());
+            this->swap(tmp);
+        }
+        return *this;
+    }
+
+    // Kopia alokatora kolejki [O(1)]
+    Alloc get_allocator() const noexcept { return slab.get_allocator(); }
+
+    // [O(1)]
+    bool empty() const noexcept { return total == 0; }
+    size_type size() const noexcept { return total; }
+
+    // Wstawienie pary [O(log size())]
+    void insert(const K& key, const V& value) {
+        element_ref e{key, value};
+        node* parent;
+        bool left;
+        node* existing = find_pair(e, parent, left);
+        if (existing != nullptr) {
+            ++existing->count;
+            ++total;
+            return;
+        }
+
+        node* n = create_node(key, value);
+        try {
+            heap.push_back(n);
+        } catch (...) {
+            destroy_node(n);
+            throw;
+        }
+        n->slot = heap.size() - 1;
+        try {
+            fix(n->slot);
+        } catch (...) {
+            heap.pop_back();
+            destroy_node(n);
+            throw;
+        }
+        sorted_by_key.link(n, parent, left);
+        ++total;
+    }
+
+    // Najmniejsza i największa wartość oraz ich klucze [O(1)]; maksimum to
+    // większe z dzieci korzenia, więc wersje max porównują wartości
+    const V& minValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return heap[0]->value;
+    }
+    const V& maxValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return heap[max_slot()]->value;
+    }
+    const K& minKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return heap[0]->key;
+    }
+    const K& maxKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return heap[max_slot()]->key;
+    }
+
+    // Usunięcie pary o najmniejszej / największej wartości [O(log size())]
+    void deleteMin() {
+        if (empty()) return;
+        remove_one(heap[0]);
+    }
+
+    void deleteMax() {
+        if (empty()) return;
+        remove_one(heap[max_slot()]);
+    }
+
+    // Zmiana wartości w dowolnej parze o kluczu key [O(log size())]; jeśli
+    // zmieniana para jest jedyna w swoim węźle, nowy węzeł zajmuje jej
+    // miejsce w tablicy
+    void changeValue(const K& key, const V& value) {
+        node* old = sorted_by_key.find(key, KeyComparer());
+        if (old == nullptr) throw PriorityQueueNotFoundException();
+
+        element_ref e{key, value};
+        node* parent;
+        bool left;
+        node* existing = find_pair(e, parent, left);
+        // ta sama para - nic się nie zmienia
+        if (existing == old) return;
+
+        if (existing != nullptr) {
+            remove_one(old);
+            ++existing->count;
+            ++total;
+            return;
+        }
+
+        if (old->count > 1) {
+            insert(key, value);
+            --old->count;
+            --total;
+            return;
+        }
+
+        node* n = create_node(key, value);
+        size_type i = old->slot;
+        heap[i] = n;
+        n->slot = i;
+        try {
+            fix(i);
+        } catch (...) {
+            heap[i] = old;
+            destroy_node(n);
+            throw;
+        }
+        sorted_by_key.link(n, parent, left);
+        sorted_by_key.unlink(old);
+        destroy_node(old);
+    }
+
+    // Scalenie z queue [O(size() + queue.size())]: scalamy drzewa po kluczu
+    // (odsiewając równe pary) i budujemy kopiec od dołu. Węzły queue są
+    // przepinane, a nie kopiowane (przy różnych alokatorach scalamy kopię
+    // queue).
+    void merge(PriorityQueue& queue) {
+        if (this == &queue || queue.empty()) return;
+        if (!(get_allocator() == queue.get_allocator())) {
+            PriorityQueue copy(queue, get_allocator());
+            PriorityQueue emptied(queue.get_allocator());
+            merge(copy);
+            queue.swap(emptied);
+            return;
+        }
+        if (empty()) {
+            this->swap(queue);
+            return;
+        }
+
+        KeyValueComparer less;
+        // (z queue, z *this)
+        scratch_vector<std::pair<node*, node*>> duplicates(get_allocator());
+        scratch_vector<node*> in_order(get_allocator());
+        scratch_vector<node*> merged(get_allocator());
+        merged.reserve(heap.size() + queue.heap.size());
+        merged = heap;
+
+        node* a = sorted_by_key.first;
+        node* b = queue.sorted_by_key.first;
+        while (a != nullptr || b != nullptr) {
+            if (b == nullptr || (a != nullptr && less(*a, *b))) {
+                in_order.push_back(a);
+                a = key_index::next(a);
+            } else if (a == nullptr || less(*b, *a)) {
+                in_order.push_back(b);
+                merged.push_back(b);
+                b = key_index::next(b);
+            } else {
+                duplicates.emplace_back(b, a);
+                b = key_index::next(b);
+            }
+        }
+
+        // Budowa kopca od dołu na nowej tablicy; jeśli porównanie rzuci,
+        // wracamy do starych tablic i poprawiamy pozycje węzłów
+        heap.swap(merged);
+        for (size_type i = 0; i < heap.size(); ++i) heap[i]->slot = i;
+        try {
+            for (size_type i = heap.size() / 2; i-- > 0;)
+                trickle_down(i, nullptr);
+        } catch (...) {
+            heap.swap(merged);
+            for (size_type i = 0; i < heap.size(); ++i) heap[i]->slot = i;
+            for (size_type i = 0; i < queue.heap.size(); ++i)
+                queue.heap[i]->slot = i;
+            throw;
+        }
+
+        // Od tego miejsca nic nie rzuca
+        sorted_by_key.build(in_order.begin(), in_order.end());
+        slab.splice(queue.slab);
+        for (const std::pair<node*, node*>& d : duplicates) {
+            d.second->count += d.first->count;
+            destroy_node(d.first);
+        }
+        total += queue.total;
+        queue.heap.clear();
+        queue.sorted_by_key.clear();
+        queue.total = 0;
+    }
+
+    // [O(1)], gwarancja no-throw; alokatory jak w silniku drzewiastym (przy
+    // różnych alokatorach bez propagate_on_container_swap zachowanie jest
+    // niezdefiniowane, tak jak dla kontenerów standardowych)
+    void swap(PriorityQueue& queue) noexcept {
+        if (this == &queue) return;
+        slab.swap(queue.slab);
+        heap.swap(queue.heap);
+        sorted_by_key.swap(queue.sorted_by_key);
+        std::swap(total, queue.total);
+        std::swap(seed, queue.seed);
+    }
+
+    friend void swap(PriorityQueue& lhs, PriorityQueue& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    // Równość [O(size())] - porównujemy drzewa po kluczu
+    friend bool operator==(const PriorityQueue& lhs, const PriorityQueue& rhs) {
+        using priority_queue_detail::compare_equal;
+        if (lhs.total != rhs.total) return false;
+        node* a = lhs.sorted_by_key.first;
+        node* b = rhs.sorted_by_key.first;
+        while (a != nullptr && b != nullptr) {
+            if (a->count != b->count || !compare_equal(a->key, b->key) ||
+                !compare_equal(a->value, b->value))
+                return false;
+            a = key_index::next(a);
+            b = key_index::next(b);
+        }
+        return a == nullptr && b == nullptr;
+    }
+    friend bool operator!=(const PriorityQueue& lhs, const PriorityQueue& rhs) {
+        return !(lhs == rhs);
+    }
+    // Porównanie leksykograficzne [O(size() * log size())] - pary trzeba
+    // najpierw posortować po wartości
+    friend bool operator<(const PriorityQueue& lhs, const PriorityQueue& rhs) {
+        scratch_vector<const node*> a = lhs.expanded(), b = rhs.expanded();
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(),
+                                            b.end(), ValueKeyComparer());
+    }
+    friend bool operator>(const PriorityQueue& lhs, const PriorityQueue& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const PriorityQueue& lhs, const PriorityQueue& rhs) {
+        return !(lhs > rhs);
+    }
+    friend bool operator>=(const PriorityQueue& lhs, const PriorityQueue& rhs) {
+        return !(lhs < rhs);
+    }
+
+   protected:
+    // Pary z powtórzeniami posortowane po wartości, a potem po kluczu
+    scratch_vector<const node*> expanded() const {
+        scratch_vector<const node*> out(heap.begin(), heap.end(),
+                                        get_allocator());
+        std::sort(out.begin(), out.end(), ValueKeyComparer());
+        scratch_vector<const node*> result(get_allocator());
+        result.reserve(total);
+        for (const node* n : out) result.insert(result.end(), n->count, n);
+        return result;
+    }
+};
+
+#endif /* end of include guard: _JNP1_MINMAXHEAP_HH_ */
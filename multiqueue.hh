@@ -0,0 +1,198 @@
+#ifndef _JNP1_MULTIQUEUE_HH_
+#define _JNP1_MULTIQUEUE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "priorityqueue.hh"
+
+// Zrelaksowana kolejka priorytetowa dla wielu wątków (MultiQueue, Rihani,
+// Sanders, Dementiev). Pary trafiają do losowej spośród wielu zwykłych
+// PriorityQueue, a popMin bierze mniejsze z minimów kilku losowo wybranych
+// kolejek (domyślnie dwóch), blokując je przez try_lock. Usunięta para nie
+// musi być globalnym minimum - jej oczekiwana pozycja (rank) wśród par
+// w kolejce jest rzędu liczby kolejek, więc błąd reguluje się liczbą
+// kolejek (queues) i liczbą losowanych kolejek (choices): mniej kolejek
+// i więcej losowań to mniejszy błąd, ale większa rywalizacja o blokady.
+//
+// Ponieważ para o danym kluczu może być w dowolnej kolejce, changeValue nie
+// jest dostępne.
+template <typename K, typename V>
+class MultiQueue {
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+
+   protected:
+    struct part {
+        std::mutex lock;
+        PriorityQueue<K, V> queue;
+    };
+
+    // Po tylu nieudanych losowaniach przestajemy zgadywać i przeglądamy
+    // wszystkie kolejki
+    static const unsigned max_attempts = 64;
+    static const unsigned max_choices = 8;
+
+    std::unique_ptr<part[]> parts;
+    size_type part_count;
+    unsigned choices;
+    std::atomic<size_type> total{0};
+    std::atomic<std::uint32_t> seeds{0};
+
+    // Generator losowy wątku (xorshift); każdy wątek dostaje inne ziarno
+    std::uint32_t random() {
+        static thread_local std::uint32_t state = 0;
+        if (state == 0) {
+            std::uint32_t thread = static_cast<std::uint32_t>(
+                std::hash<std::thread::id>()(std::this_thread::get_id()));
+            state = 2463534242u ^ (seeds.fetch_add(1) * 0x9e3779b9u) ^ thread;
+            if (state == 0) state = 1;
+        }
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Wykonuje remove na zablokowanej kolejce z najmniejszym minimum spośród
+    // choices różnych, losowo wybranych kolejek; zwraca false, jeśli kolejka
+    // jest pusta
+    template <typename Remove>
+    bool remove_small(Remove remove) {
+        using priority_queue_detail::compare_less;
+        std::unique_lock<std::mutex> guards[max_choices];
+        size_type chosen[max_choices];
+        for (unsigned attempt = 0; attempt < max_attempts; ++attempt) {
+            if (total.load() == 0) return false;
+
+            part* best = nullptr;
+            for (unsigned c = 0; c < choices; ++c) {
+                // różne kolejki - drugi try_lock tego samego muteksu w tym
+                // samym wątku byłby niezdefiniowany
+                size_type i;
+                do {
+                    i = random() % part_count;
+                } while (std::find(chosen, chosen + c, i) != chosen + c);
+                chosen[c] = i;
+
+                part& p = parts[i];
+                guards[c] =
+                    std::unique_lock<std::mutex>(p.lock, std::try_to_lock);
+                if (!guards[c] || p.queue.empty()) continue;
+                if (best == nullptr || compare_less(p.queue.minValue(),
+                                                    best->queue.minValue()))
+                    best = &p;
+            }
+            if (best != nullptr) {
+                remove(best->queue);
+                --total;
+                return true;
+            }
+            for (unsigned c = 0; c < choices; ++c)
+                if (guards[c]) guards[c].unlock();
+        }
+
+        // Pary są w niewielu kolejkach albo rywalizacja jest duża - przeglądamy
+        // wszystkie kolejki przez try_lock, trzymając naraz tylko najlepszą
+        // dotąd i bieżącą, i usuwamy najmniejsze minimum spośród kolejek,
+        // których nikt nie blokował. try_lock nie czeka, więc nie ma
+        // zakleszczenia; gdy wszystkie niepuste kolejki były zajęte,
+        // próbujemy znowu.
+        while (total.load() != 0) {
+            std::unique_lock<std::mutex> best_guard;
+            part* best = nullptr;
+            for (size_type i = 0; i < part_count; ++i) {
+                part& p = parts[i];
+                std::unique_lock<std::mutex> guard(p.lock, std::try_to_lock);
+                if (!guard || p.queue.empty()) continue;
+                if (best == nullptr ||
+                    compare_less(p.queue.minValue(), best->queue.minValue())) {
+                    best = &p;
+                    best_guard = std::move(guard);
+                }
+            }
+            if (best != nullptr) {
+                remove(best->queue);
+                --total;
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    // Akcje dla remove_small
+    struct pop_into {
+        K& key;
+        V& value;
+
+        void operator()(PriorityQueue<K, V>& queue) const {
+            key = queue.minKey();
+            value = queue.minValue();
+            queue.deleteMin();
+        }
+    };
+
+    struct drop {
+        void operator()(PriorityQueue<K, V>& queue) const {
+            queue.deleteMin();
+        }
+    };
+
+   public:
+    // Kolejka z queues kolejkami wewnętrznymi (domyślnie cztery na każdy
+    // wątek sprzętowy), z których popMin losuje choices (od 1 do 8, nie
+    // więcej niż queues)
+    explicit MultiQueue(
+        size_type queues = 4 * std::thread::hardware_concurrency(),
+        unsigned choices = 2)
+        : parts(new part[queues > 0 ? queues : 1]),
+          part_count(queues > 0 ? queues : 1),
+          choices(choices > 0 ? choices : 1) {
+        if (this->choices > max_choices) this->choices = max_choices;
+        if (this->choices > part_count)
+            this->choices = static_cast<unsigned>(part_count);
+    }
+
+    MultiQueue(const MultiQueue&) = delete;
+    MultiQueue& operator=(const MultiQueue&) = delete;
+
+    // [O(1)]; w trakcie równoległych operacji wynik może być już nieaktualny
+    bool empty() const noexcept { return total.load() == 0; }
+    size_type size() const noexcept { return total.load(); }
+    size_type queues() const noexcept { return part_count; }
+
+    // Wstawienie pary do losowej kolejki, której nikt nie blokuje
+    // [O(log size())]
+    void insert(const K& key, const V& value) {
+        for (unsigned attempt = 0;; ++attempt) {
+            part& p = parts[random() % part_count];
+            std::unique_lock<std::mutex> guard(p.lock, std::defer_lock);
+            if (attempt < max_attempts) {
+                if (!guard.try_lock()) continue;
+            } else {
+                guard.lock();
+            }
+            p.queue.insert(key, value);
+            ++total;
+            return;
+        }
+    }
+
+    // Usuwa parę o małej (niekoniecznie najmniejszej) wartości i zwraca ją
+    // w key i value [O(choices * log size())]; zwraca false, jeśli kolejka
+    // jest pusta
+    bool popMin(K& key, V& value) { return remove_small(pop_into{key, value}); }
+
+    // Jak popMin, ale bez zwracania pary
+    void deleteMin() { remove_small(drop()); }
+};
+
+#endif /* end of include guard: _JNP1_MULTIQUEUE_HH_ */
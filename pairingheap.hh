@@ -0,0 +1,423 @@
+#ifndef _JNP1_PAIRINGHEAP_HH_
+#define _JNP1_PAIRINGHEAP_HH_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+// Silnik oparty na kopcu parującym: insert i merge w O(1), deleteMin
+// w O(log size()) zamortyzowanym. Kopiec zna tylko minimum, więc maxValue,
+// maxKey i deleteMax nie są dostępne. Każda wstawiona para ma własny węzeł
+// (równe pary nie są scalane, bo wymagałoby to wyszukiwania przy insert),
+// więc silnik działa z HeapQueue:
+//   HeapQueue<int, int, PairingHeapBackend> queue;
+struct PairingHeapBackend {};
+
+template <>
+struct is_heap_backend<PairingHeapBackend> : std::true_type {};
+
+template <typename K, typename V, typename Alloc>
+class HeapQueue<K, V, PairingHeapBackend, Alloc> {
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+
+   protected:
+    struct node {
+        // kopiec w reprezentacji "pierwsze dziecko - następny brat"; prev to
+        // poprzedni brat albo rodzic (dla pierwszego dziecka)
+        node* child = nullptr;
+        node* next = nullptr;
+        node* prev = nullptr;
+        // indeks po kluczu; węzeł spoza indeksu (indexed == false) czeka na
+        // liście pending, powiązanej przez by_key.left i by_key.right
+        priority_queue_detail::tree_hook<node> by_key;
+        bool indexed = false;
+        unsigned priority;
+        K key;
+        V value;
+
+        node(const K& key, const V& value, unsigned priority)
+            : priority(priority), key(key), value(value) {}
+    };
+
+    // Komparatory
+    class ValueComparer {
+       public:
+        bool operator()(const node* lhs, const node* rhs) const {
+            return priority_queue_detail::compare_less(lhs->value, rhs->value);
+        }
+    };
+
+    class ValueKeyComparer {
+       public:
+        bool operator()(const node* lhs, const node* rhs) const {
+            using priority_queue_detail::compare_less;
+            if (compare_less(lhs->value, rhs->value)) return true;
+            if (compare_less(rhs->value, lhs->value)) return false;
+            return compare_less(lhs->key, rhs->key);
+        }
+    };
+
+    // Zaplanowane podpięcie child jako dziecka parent
+    struct heap_link {
+        node* parent;
+        node* child;
+    };
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    template <typename T>
+    using scratch_vector = priority_queue_detail::scratch_vector<T, Alloc>;
+
+    // węzły (z pamięcią) i ich indeks po kluczu (dla changeValue)
+    priority_queue_detail::lazy_key_index<node, Alloc> nodes;
+    // korzeń kopca (najmniejsza wartość)
+    node* root = nullptr;
+    size_type total = 0;
+    // bufory na plany przebudowy kopca (żeby nie alokować przy każdej
+    // operacji); między operacjami nie trzymają nic ważnego
+    scratch_vector<node*> roots_buffer;
+    scratch_vector<heap_link> links_buffer;
+
+   protected:
+    void destroy_all() noexcept {
+        nodes.destroy_all();
+        root = nullptr;
+        total = 0;
+    }
+
+    // Podpina child (korzeń innego kopca) jako pierwsze dziecko parent [O(1)]
+    static void attach(node* parent, node* child) noexcept {
+        child->prev = parent;
+        child->next = parent->child;
+        if (parent->child != nullptr) parent->child->prev = child;
+        parent->child = child;
+    }
+
+    // Odcina n (razem z poddrzewem) od rodzica [O(1)]
+    static void cut(node* n) noexcept {
+        if (n->prev->child == n)
+            n->prev->child = n->next;
+        else
+            n->prev->next = n->next;
+        if (n->next != nullptr) n->next->prev = n->prev;
+        n->prev = n->next = nullptr;
+    }
+
+    // Planowanie przebudowy kopca: same porównania (mogą rzucić), wynik
+    // trafia do links_buffer i jest stosowany przez apply_links (no-throw).
+    // Porządek węzłów nie zmienia się w trakcie operacji, więc wyniki
+    // porównań można zebrać przed pierwszą modyfikacją - stąd silna
+    // gwarancja.
+
+    // Scalenie dwóch kopców; zwraca nowy korzeń
+    node* plan_meld(node* a, node* b) {
+        if (a == nullptr) return b;
+        if (b == nullptr) return a;
+        if (ValueComparer()(b, a)) std::swap(a, b);
+        links_buffer.push_back(heap_link{a, b});
+        return a;
+    }
+
+    // Scalenie dzieci n dwoma przejściami (w parach od lewej, potem od
+    // prawej do lewej); zwraca nowy korzeń [O(log size()) zamortyzowane]
+    node* plan_combine_children(node* n) {
+        roots_buffer.clear();
+        for (node* c = n->child; c != nullptr; c = c->next)
+            roots_buffer.push_back(c);
+        if (roots_buffer.empty()) return nullptr;
+
+        size_type pairs = 0;
+        for (size_type i = 0; i < roots_buffer.size(); i += 2) {
+            roots_buffer[pairs++] =
+                (i + 1 < roots_buffer.size())
+                    ? plan_meld(roots_buffer[i], roots_buffer[i + 1])
+                    : roots_buffer[i];
+        }
+        node* acc = roots_buffer[pairs - 1];
+        for (size_type j = pairs - 1; j-- > 0;)
+            acc = plan_meld(roots_buffer[j], acc);
+        return acc;
+    }
+
+    void apply_links(node* new_root) noexcept {
+        for (const heap_link& l : links_buffer) attach(l.parent, l.child);
+        links_buffer.clear();
+        if (new_root != nullptr) new_root->prev = new_root->next = nullptr;
+        root = new_root;
+    }
+
+    // Węzły posortowane po wartości, a potem po kluczu [O(size() *
+    // log size())]
+    scratch_vector<const node*> sorted_nodes() const {
+        scratch_vector<const node*> out(get_allocator());
+        out.reserve(total);
+        nodes.for_each([&out](node* n) { out.push_back(n); });
+        std::sort(out.begin(), out.end(), ValueKeyComparer());
+        return out;
+    }
+
+   public:
+    // Konstruktor bezparametrowy tworzący pustą kolejkę [O(1)]
+    HeapQueue() : HeapQueue(Alloc()) {}
+
+    // Pusta kolejka korzystająca z alokatora alloc [O(1)]
+    explicit HeapQueue(const Alloc& alloc)
+        : nodes(alloc), roots_buffer(alloc), links_buffer(alloc) {}
+
+    // Konstruktor kopiujący [O(queue.size())]
+    HeapQueue(const HeapQueue& queue)
+        : HeapQueue(queue,
+                    alloc_traits::select_on_container_copy_construction(
+                        queue.get_allocator())) {}
+
+    // Kopia queue w pamięci z alokatora alloc [O(queue.size())]
+    // Kopiujemy kształt kopca; kopie trafiają na pending
+    HeapQueue(const HeapQueue& queue, const Alloc& alloc)
+        : HeapQueue(alloc) {
+        total = queue.total;
+        if (queue.root == nullptr) return;
+        // pary (oryginał, kopia), których dzieci i braci trzeba skopiować
+        scratch_vector<std::pair<const node*, node*>> stack(alloc);
+        try {
+            stack.reserve(16);
+            root = nodes.create(queue.root->key, queue.root->value);
+            nodes.push_pending(root);
+            stack.emplace_back(queue.root, root);
+            while (!stack.empty()) {
+                const node* from = stack.back().first;
+                node* to = stack.back().second;
+                stack.pop_back();
+                if (from->child != nullptr) {
+                    node* c =
+                        nodes.create(from->child->key, from->child->value);
+                    nodes.push_pending(c);
+                    c->prev = to;
+                    to->child = c;
+                    stack.emplace_back(from->child, c);
+                }
+                if (from->next != nullptr) {
+                    node* s = nodes.create(from->next->key, from->next->value);
+                    nodes.push_pending(s);
+                    s->prev = to;
+                    to->next = s;
+                    stack.emplace_back(from->next, s);
+                }
+            }
+        } catch (...) {
+            destroy_all();
+            throw;
+        }
+    }
+
+    // Konstruktor przenoszący [O(1)]
+    HeapQueue(HeapQueue&& queue) noexcept
+        : HeapQueue(queue.get_allocator()) {
+        this->swap(queue);
+    }
+
+    // [O(size()), a dla trywialnie niszczalnych K i V O(liczba kawałków
+    // puli)]
+    ~HeapQueue() {
+        if (!std::is_trivially_destructible<node>::value) destroy_all();
+    }
+
+    // Operator przypisania [O(queue.size()) dla użycia P = Q, a O(1) dla użycia
+    // P = move(Q)]; alokator przechodzi tak jak w silniku drzewiastym
+    HeapQueue& operator=(const HeapQueue& queue) {
+        if (this == &queue) return *this;
+        HeapQueue tmp(
+            queue, alloc_traits::propagate_on_container_copy_assignment::value
+                       ? queue.get_allocator()
+                       : get_allocator());
+        this->swap(tmp);
+        return *this;
+    }
+
+    HeapQueue& operator=(HeapQueue&& queue) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value) {
+        if (this == &queue) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            get_allocator() == queue.get_allocator()) {
+            HeapQueue tmp(std::move(queue));
+            this->swap(tmp);
+        } else {
+            HeapQueue tmp(queue, get_allocator());
+            this->swap(tmp);
+        }
+        return *this;
+    }
+
+    // Kopia alokatora kolejki [O(1)]
+    Alloc get_allocator() const noexcept { return nodes.get_allocator(); }
+
+    // [O(1)]
+    bool empty() const noexcept { return total == 0; }
+    size_type size() const noexcept { return total; }
+
+    // Wstawienie pary [O(1)]; jedno porównanie z korzeniem
+    void insert(const K& key, const V& value) {
+        node* n = nodes.create(key, value);
+        bool smaller;
+        try {
+            smaller = root != nullptr && ValueComparer()(n, root);
+        } catch (...) {
+            nodes.destroy(n);
+            throw;
+        }
+
+        if (root == nullptr) {
+            root = n;
+        } else if (smaller) {
+            attach(n, root);
+            root = n;
+        } else {
+            attach(root, n);
+        }
+        nodes.push_pending(n);
+        ++total;
+    }
+
+    // Najmniejsza wartość i jej klucz [O(1)]
+    const V& minValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return root->value;
+    }
+    const K& minKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        return root->key;
+    }
+
+    // Kopiec nie zna maksimum
+    const V& maxValue() const = delete;
+    const K& maxKey() const = delete;
+    void deleteMax() = delete;
+
+    // Usunięcie pary o najmniejszej wartości [O(log size()) zamortyzowane]
+    void deleteMin() {
+        if (empty()) return;
+        node* new_root;
+        try {
+            new_root = plan_combine_children(root);
+        } catch (...) {
+            links_buffer.clear();
+            throw;
+        }
+
+        node* old = root;
+        apply_links(new_root);
+        nodes.unindex(old);
+        nodes.destroy(old);
+        --total;
+    }
+
+    // Zmiana wartości w dowolnej parze o kluczu key [O(log size())
+    // zamortyzowane, plus O(p * log size()) za p par wstawionych od
+    // poprzedniego changeValue]; PriorityQueueNotFoundException, gdy nie ma
+    // takiego klucza
+    void changeValue(const K& key, const V& value) {
+        nodes.flush();
+        node* old = nodes.find(key);
+        if (old == nullptr) throw PriorityQueueNotFoundException();
+
+        node* n = nodes.create(key, value);
+        node* new_root;
+        try {
+            node* rest = (old == root) ? nullptr : root;
+            new_root = plan_meld(plan_meld(rest, plan_combine_children(old)),
+                                 n);
+        } catch (...) {
+            links_buffer.clear();
+            nodes.destroy(n);
+            throw;
+        }
+
+        if (old != root) cut(old);
+        apply_links(new_root);
+        nodes.unindex(old);
+        nodes.destroy(old);
+        nodes.push_pending(n);
+    }
+
+    // Scalenie z queue [O(1), plus O(queue.size()), jeśli na queue wołano
+    // changeValue]; węzły queue są przepinane, a nie kopiowane
+    // (przy różnych alokatorach scalamy kopię queue [O(queue.size())])
+    void merge(HeapQueue& queue) {
+        if (this == &queue || queue.empty()) return;
+        if (!(get_allocator() == queue.get_allocator())) {
+            HeapQueue copy(queue, get_allocator());
+            HeapQueue emptied(queue.get_allocator());
+            merge(copy);
+            queue.swap(emptied);
+            return;
+        }
+        if (empty()) {
+            this->swap(queue);
+            return;
+        }
+        bool smaller = ValueComparer()(queue.root, root);
+
+        if (smaller) {
+            attach(queue.root, root);
+            root = queue.root;
+        } else {
+            attach(root, queue.root);
+        }
+        nodes.splice(queue.nodes);
+        total += queue.total;
+
+        queue.root = nullptr;
+        queue.total = 0;
+    }
+
+    // [O(1)], gwarancja no-throw; alokatory jak w silniku drzewiastym
+    // (bufory zostają na miejscu)
+    void swap(HeapQueue& queue) noexcept {
+        if (this == &queue) return;
+        nodes.swap(queue.nodes);
+        std::swap(root, queue.root);
+        std::swap(total, queue.total);
+    }
+
+    friend void swap(HeapQueue& lhs, HeapQueue& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    // Porównania [O(size() * log size())] - kopiec trzeba najpierw
+    // posortować
+    friend bool operator==(const HeapQueue& lhs, const HeapQueue& rhs) {
+        using priority_queue_detail::compare_equal;
+        if (lhs.total != rhs.total) return false;
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        for (size_type i = 0; i < a.size(); ++i)
+            if (!compare_equal(a[i]->key, b[i]->key) ||
+                !compare_equal(a[i]->value, b[i]->value))
+                return false;
+        return true;
+    }
+    friend bool operator!=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const HeapQueue& lhs, const HeapQueue& rhs) {
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(),
+                                            b.end(), ValueKeyComparer());
+    }
+    friend bool operator>(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs > rhs);
+    }
+    friend bool operator>=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs < rhs);
+    }
+};
+
+#endif /* end of include guard: _JNP1_PAIRINGHEAP_HH_ */
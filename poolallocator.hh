@@ -0,0 +1,162 @@
+#ifndef _JNP1_POOLALLOCATOR_HH_
+#define _JNP1_POOLALLOCATOR_HH_
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace priority_queue_detail {
+
+// Pula bloków o rozmiarach będących potęgami dwójki (od 16 B do 1 MiB).
+// Bloki są wycinane kolejno z dużych aren, a zwolnione trafiają na listę
+// wolnych swojego rozmiaru i są używane ponownie; areny wracają do systemu
+// dopiero razem z pulą. Większe żądania idą prosto do operator new.
+// Pula nie jest bezpieczna dla wielu wątków.
+class block_pool {
+    static const std::size_t min_shift = 4;
+    static const std::size_t max_shift = 20;
+    static const std::size_t class_count = max_shift - min_shift + 1;
+    static const std::size_t arena_bytes = std::size_t(64) << 10;
+
+    struct free_block {
+        free_block* next;
+    };
+
+    // Nagłówek areny; zajmuje cały pierwszy blok najmniejszego rozmiaru,
+    // więc bloki zaczynają się na granicy 16 bajtów
+    struct arena {
+        arena* next;
+    };
+
+    static_assert(sizeof(arena) <= (std::size_t(1) << min_shift),
+                  "arena header does not fit in the smallest block");
+    static_assert(alignof(std::max_align_t) <= (std::size_t(1) << min_shift),
+                  "blocks would be under-aligned");
+
+    free_block* free_lists[class_count];
+    arena* arenas;
+    char* cursor;
+    char* limit;
+
+    static std::size_t size_class(std::size_t bytes) noexcept {
+        std::size_t c = 0;
+        while ((std::size_t(1) << (c + min_shift)) < bytes) ++c;
+        return c;
+    }
+
+    // Nowa arena, z której zmieści się co najmniej blok o rozmiarze bytes;
+    // resztka poprzedniej areny przepada
+    void refill(std::size_t bytes) {
+        std::size_t size = std::size_t(1) << min_shift;
+        size += (bytes > arena_bytes - size) ? bytes : arena_bytes - size;
+        char* raw = static_cast<char*>(::operator new(size));
+        arena* a = reinterpret_cast<arena*>(raw);
+        a->next = arenas;
+        arenas = a;
+        cursor = raw + (std::size_t(1) << min_shift);
+        limit = raw + size;
+    }
+
+   public:
+    static const std::size_t max_block = std::size_t(1) << max_shift;
+
+    block_pool() noexcept : arenas(nullptr), cursor(nullptr), limit(nullptr) {
+        for (free_block*& f : free_lists) f = nullptr;
+    }
+
+    block_pool(const block_pool&) = delete;
+    block_pool& operator=(const block_pool&) = delete;
+
+    ~block_pool() {
+        while (arenas != nullptr) {
+            arena* a = arenas;
+            arenas = a->next;
+            ::operator delete(a);
+        }
+    }
+
+    // Blok co najmniej bytes bajtów [O(1) zamortyzowane]
+    void* allocate(std::size_t bytes) {
+        if (bytes > max_block) return ::operator new(bytes);
+        std::size_t c = size_class(bytes);
+        if (free_block* f = free_lists[c]) {
+            free_lists[c] = f->next;
+            return f;
+        }
+        std::size_t size = std::size_t(1) << (c + min_shift);
+        if (static_cast<std::size_t>(limit - cursor) < size) refill(size);
+        void* p = cursor;
+        cursor += size;
+        return p;
+    }
+
+    // Oddaje blok przydzielony przez allocate(bytes) [O(1)]
+    void deallocate(void* p, std::size_t bytes) noexcept {
+        if (bytes > max_block) {
+            ::operator delete(p);
+            return;
+        }
+        free_block* f = static_cast<free_block*>(p);
+        std::size_t c = size_class(bytes);
+        f->next = free_lists[c];
+        free_lists[c] = f;
+    }
+};
+
+}  // namespace priority_queue_detail
+
+// Alokator korzystający ze wspólnej puli bloków. Kopie (także przepięte na
+// inny typ) korzystają z tej samej puli i są sobie równe; domyślny
+// konstruktor tworzy nową pulę. Pula żyje, dopóki żyje któraś kopia.
+// Alokator przechodzi przy kopiowaniu, przenoszeniu i zamianie kontenerów.
+//
+// Kolejka z tym alokatorem (PriorityQueue<K, V, TreeBackend,
+// PoolAllocator<std::pair<const K, V>>>) bierze z puli kawałki pamięci na
+// węzły i pomocnicze kontenery, więc po rozgrzaniu puli jej operacje (także
+// insert_many, merge i kopie) nie wołają malloc. Jak pula - nie jest
+// bezpieczny dla wielu wątków.
+template <typename T>
+class PoolAllocator {
+    template <typename U>
+    friend class PoolAllocator;
+
+    std::shared_ptr<priority_queue_detail::block_pool> pool;
+
+   public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "over-aligned types are not supported");
+
+    PoolAllocator()
+        : pool(std::make_shared<priority_queue_detail::block_pool>()) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        return static_cast<T*>(pool->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        pool->deallocate(p, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const noexcept {
+        return pool == other.pool;
+    }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const noexcept {
+        return pool != other.pool;
+    }
+};
+
+#endif /* end of include guard: _JNP1_POOLALLOCATOR_HH_ */
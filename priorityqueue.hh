@@ -1,11 +1,23 @@
 #ifndef _JNP1_PRIORITYQUEUE_HH_
 #define _JNP1_PRIORITYQUEUE_HH_
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
-#include <map>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
-#include <set>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 class PriorityQueueEmptyException : public std::exception {
    public:
@@ -23,173 +35,2168 @@ class PriorityQueueNotFoundException : public std::exception {
     }
 };
 
-template <typename K, typename V>
-class PriorityQueue {
+#ifdef PRIORITY_QUEUE_STATS
+// Tryb pomiarowy (kompilacja z -DPRIORITY_QUEUE_STATS): każda kolejka
+// z silnikiem drzewiastym liczy dla każdej metody publicznej wywołania,
+// alokacje (pula węzłów i pomocnicze kontenery), zaalokowane bajty,
+// porównania kluczy i wartości oraz odwiedzone węzły drzew. Bez tej flagi
+// liczników nie ma ani w kolejce, ani w kodzie.
+struct PriorityQueueCounters {
+    std::size_t calls = 0;
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t comparisons = 0;
+    std::size_t nodes = 0;
+};
+
+class PriorityQueueStats {
+   public:
+    enum method {
+        insert,
+        insert_many,
+        deleteMin,
+        deleteMax,
+        changeValue,
+        changeValues,
+        erase,
+        merge,
+        copy,
+        build,
+        extremes,
+        equal,
+        less,
+        order,
+        method_count
+    };
+
+    static const char* name(method m) noexcept {
+        static const char* const names[method_count] = {
+            "insert",       "insert_many", "deleteMin", "deleteMax",
+            "changeValue",  "changeValues", "erase",    "merge",
+            "copy",         "build",        "extremes", "equal",
+            "less",         "order"};
+        return names[m];
+    }
+
+    PriorityQueueCounters& operator[](method m) noexcept {
+        return counters[m];
+    }
+    const PriorityQueueCounters& operator[](method m) const noexcept {
+        return counters[m];
+    }
+
+    // Suma liczników wszystkich metod
+    PriorityQueueCounters total() const noexcept {
+        PriorityQueueCounters sum;
+        for (const PriorityQueueCounters& c : counters) {
+            sum.calls += c.calls;
+            sum.allocations += c.allocations;
+            sum.bytes += c.bytes;
+            sum.comparisons += c.comparisons;
+            sum.nodes += c.nodes;
+        }
+        return sum;
+    }
+
+    void reset() noexcept { *this = PriorityQueueStats(); }
+
+   private:
+    PriorityQueueCounters counters[method_count];
+};
+
+// Liczniki trafiają do metody, która jest aktualnie wykonywana w tym wątku
+// (najbardziej zewnętrznej - insert_many nie liczy się jako merge)
+#define PRIORITY_QUEUE_COUNT(field, amount) \
+    priority_queue_detail::count(&PriorityQueueCounters::field, amount)
+#define PRIORITY_QUEUE_SCOPE(queue, m)                 \
+    priority_queue_detail::stats_scope stats_scope_( \
+        (queue).statistics[PriorityQueueStats::m])
+#else
+#define PRIORITY_QUEUE_COUNT(field, amount) static_cast<void>(0)
+#define PRIORITY_QUEUE_SCOPE(queue, m) static_cast<void>(0)
+#endif
+
+namespace priority_queue_detail {
+
+#ifdef PRIORITY_QUEUE_STATS
+inline PriorityQueueCounters*& active_counters() noexcept {
+    static thread_local PriorityQueueCounters* active = nullptr;
+    return active;
+}
+
+inline void count(std::size_t PriorityQueueCounters::*field,
+                  std::size_t amount) noexcept {
+    if (PriorityQueueCounters* c = active_counters()) c->*field += amount;
+}
+
+// Ustawia liczniki metody na czas jej wykonania (RAII); zagnieżdżone
+// wywołania, także na innych kolejkach, liczą się do zewnętrznej metody
+class stats_scope {
+    PriorityQueueCounters* outer;
+
+   public:
+    explicit stats_scope(PriorityQueueCounters& counters) noexcept
+        : outer(active_counters()) {
+        if (outer != nullptr) return;
+        ++counters.calls;
+        active_counters() = &counters;
+    }
+    ~stats_scope() { active_counters() = outer; }
+
+    stats_scope(const stats_scope&) = delete;
+    stats_scope& operator=(const stats_scope&) = delete;
+};
+
+// Alokator pomocniczych kontenerów kolejki: alokator kolejki Alloc (już
+// przepięty na właściwy typ), który dodatkowo zlicza alokacje
+template <typename Alloc>
+class scratch_allocator : public Alloc {
+    using traits = std::allocator_traits<Alloc>;
+
+   public:
+    using value_type = typename traits::value_type;
+    using pointer = typename traits::pointer;
+    using size_type = typename traits::size_type;
+
+    template <typename U>
+    struct rebind {
+        using other =
+            scratch_allocator<typename traits::template rebind_alloc<U>>;
+    };
+
+    // Z dowolnego alokatora, z którego da się utworzyć Alloc (także
+    // z innego scratch_allocator)
+    template <typename A>
+    scratch_allocator(const A& alloc) noexcept : Alloc(alloc) {}
+
+    pointer allocate(size_type n) {
+        PRIORITY_QUEUE_COUNT(allocations, 1);
+        PRIORITY_QUEUE_COUNT(bytes, n * sizeof(value_type));
+        return traits::allocate(*this, n);
+    }
+    void deallocate(pointer p, size_type n) noexcept {
+        traits::deallocate(*this, p, n);
+    }
+
+    friend bool operator==(const scratch_allocator& lhs,
+                           const scratch_allocator& rhs) noexcept {
+        return static_cast<const Alloc&>(lhs) == static_cast<const Alloc&>(rhs);
+    }
+    friend bool operator!=(const scratch_allocator& lhs,
+                           const scratch_allocator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+};
+#else
+template <typename Alloc>
+using scratch_allocator = Alloc;
+#endif
+
+template <typename Alloc, typename T>
+using rebind_alloc =
+    typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+// Pomocnicze kontenery kolejki - korzystają z jej alokatora (i liczą
+// alokacje w trybie pomiarowym); tworzy się je z alokatorem kolejki
+template <typename T, typename Alloc>
+using scratch_vector =
+    std::vector<T, scratch_allocator<rebind_alloc<Alloc, T>>>;
+template <typename Key, typename T, typename Alloc>
+using scratch_map = std::unordered_map<
+    Key, T, std::hash<Key>, std::equal_to<Key>,
+    scratch_allocator<rebind_alloc<Alloc, std::pair<const Key, T>>>>;
+
+// Porównania tolerujące operator< i operator== zadeklarowane bez const
+// (patrz mad_class w test_exceptions.cc)
+template <typename T>
+bool compare_less(const T& lhs, const T& rhs) {
+    PRIORITY_QUEUE_COUNT(comparisons, 1);
+    return const_cast<T&>(lhs) < rhs;
+}
+
+template <typename T>
+bool compare_equal(const T& lhs, const T& rhs) {
+    PRIORITY_QUEUE_COUNT(comparisons, 1);
+    return const_cast<T&>(lhs) == rhs;
+}
+
+// Domyślny komparator kluczy i wartości: operator< (także bez const, jak
+// w compare_less)
+template <typename T>
+struct default_less {
+    bool operator()(const T& lhs, const T& rhs) const {
+        return const_cast<T&>(lhs) < rhs;
+    }
+};
+
+// Porównanie komparatorem kolejki (liczone tak jak compare_less)
+template <typename Compare, typename T>
+bool compare_with(const Compare& less, const T& lhs, const T& rhs) {
+    PRIORITY_QUEUE_COUNT(comparisons, 1);
+    return less(lhs, rhs);
+}
+
+// Komparator przechowywany w kolejce. Pusty (bezstanowy) komparator jest
+// prywatną klasą bazową, więc nie zajmuje miejsca (EBO); Tag rozróżnia
+// komparatory kluczy i wartości tego samego typu. Od klasy final nie da się
+// dziedziczyć - taki komparator (rozpoznawany od C++14) jest polem.
+template <typename Compare>
+struct ebo_allowed
+    : std::integral_constant<bool, std::is_empty<Compare>::value
+#if __cplusplus >= 201402L
+                                       && !std::is_final<Compare>::value
+#endif
+                             > {
+};
+
+template <typename Compare, int Tag,
+          bool Empty = ebo_allowed<Compare>::value>
+class compare_holder : private Compare {
+   public:
+    explicit compare_holder(const Compare& compare) : Compare(compare) {}
+
+    const Compare& get() const noexcept { return *this; }
+    // pusty komparator nie ma stanu do zamiany
+    void swap(compare_holder&) noexcept {}
+};
+
+template <typename Compare, int Tag>
+class compare_holder<Compare, Tag, false> {
+   public:
+    explicit compare_holder(const Compare& compare) : compare(compare) {}
+
+    const Compare& get() const noexcept { return compare; }
+    void swap(compare_holder& other) noexcept {
+        using std::swap;
+        swap(compare, other.compare);
+    }
+
+   private:
+    Compare compare;
+};
+
+// Czy dwa komparatory na pewno porządkują tak samo: puste (bezstanowe)
+// zawsze, a te ze stanem - tylko wtedy, gdy mają operator== i są równe
+template <typename Compare>
+auto same_order(const Compare& lhs, const Compare& rhs, int)
+    -> decltype(static_cast<bool>(lhs == rhs)) {
+    return std::is_empty<Compare>::value || static_cast<bool>(lhs == rhs);
+}
+
+template <typename Compare>
+bool same_order(const Compare&, const Compare&, long) {
+    return std::is_empty<Compare>::value;
+}
+
+// Pula pamięci na węzły jednego typu. Pamięć przydzielana jest kawałkami
+// (chunk) o rosnącym rozmiarze, a zwolnione miejsca trafiają na listę wolnych
+// i są używane ponownie. Kawałki mają rozmiary będące potęgami dwójki (to
+// lubią zarówno malloc, jak i PoolAllocator) i pochodzą z alokatora Alloc.
+// Pula nie konstruuje ani nie niszczy węzłów.
+template <typename Node, typename Alloc = std::allocator<char>>
+class node_slab {
+    union slot {
+        slot* next;
+        typename std::aligned_storage<sizeof(Node), alignof(Node)>::type
+            storage;
+    };
+
+    struct chunk {
+        chunk* next;
+        std::size_t bytes;
+    };
+
+    using byte_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<char>;
+    using byte_traits = std::allocator_traits<byte_allocator>;
+    using propagate_on_swap =
+        typename byte_traits::propagate_on_container_swap;
+
+    static_assert(alignof(slot) <= alignof(std::max_align_t),
+                  "over-aligned nodes are not supported");
+
+    static constexpr std::size_t header_size =
+        (sizeof(chunk) + alignof(slot) - 1) / alignof(slot) * alignof(slot);
+    static constexpr std::size_t first_chunk_slots = 16;
+    static constexpr std::size_t max_chunk_slots = 4096;
+
+    // Najmniejsza potęga dwójki, w której mieści się nagłówek i slots miejsc
+    static constexpr std::size_t chunk_bytes(std::size_t slots,
+                                             std::size_t bytes = 1) {
+        return bytes >= header_size + slots * sizeof(slot)
+                   ? bytes
+                   : chunk_bytes(slots, 2 * bytes);
+    }
+
+    chunk* chunks;
+    slot* free_head;
+    slot* free_tail;
+    std::size_t next_chunk_bytes;
+    byte_allocator alloc;
+
+    // Dokłada kawałek pamięci i nawleka jego miejsca na listę wolnych
+    // [O(rozmiar kawałka)]; może rzucić (std::bad_alloc albo wyjątek
+    // alokatora), wtedy nic się nie zmienia
+    void grow() {
+        std::size_t bytes = next_chunk_bytes;
+        std::size_t n = (bytes - header_size) / sizeof(slot);
+        char* raw = &*byte_traits::allocate(alloc, bytes);
+        PRIORITY_QUEUE_COUNT(allocations, 1);
+        PRIORITY_QUEUE_COUNT(bytes, bytes);
+
+        chunk* c = reinterpret_cast<chunk*>(raw);
+        c->next = chunks;
+        c->bytes = bytes;
+        chunks = c;
+
+        slot* slots = reinterpret_cast<slot*>(raw + header_size);
+        for (std::size_t i = 0; i + 1 < n; ++i) slots[i].next = &slots[i + 1];
+        slots[n - 1].next = free_head;
+        if (free_head == nullptr) free_tail = &slots[n - 1];
+        free_head = &slots[0];
+
+        if (bytes < chunk_bytes(max_chunk_slots)) next_chunk_bytes = 2 * bytes;
+    }
+
+   public:
+    using allocator_type = Alloc;
+
+    explicit node_slab(const Alloc& alloc = Alloc()) noexcept
+        : chunks(nullptr),
+          free_head(nullptr),
+          free_tail(nullptr),
+          next_chunk_bytes(chunk_bytes(first_chunk_slots)),
+          alloc(alloc) {}
+
+    node_slab(const node_slab&) = delete;
+    node_slab& operator=(const node_slab&) = delete;
+
+    ~node_slab() { release(); }
+
+    Alloc get_allocator() const noexcept { return Alloc(alloc); }
+
+    // Miejsce na jeden węzeł [O(1) zamortyzowane]
+    void* allocate() {
+        if (free_head == nullptr) grow();
+        slot* s = free_head;
+        free_head = s->next;
+        if (free_head == nullptr) free_tail = nullptr;
+        return &s->storage;
+    }
+
+    // Oddaje miejsce po (zniszczonym już) węźle [O(1)]
+    void deallocate(void* p) noexcept {
+        slot* s = static_cast<slot*>(p);
+        s->next = free_head;
+        if (free_head == nullptr) free_tail = s;
+        free_head = s;
+    }
+
+    // Przejmuje całą pamięć puli other (razem z żyjącymi w niej węzłami)
+    // [O(liczba kawałków other)]; alokatory obu pul muszą być równe
+    void splice(node_slab& other) noexcept {
+        if (this == &other) return;
+        assert(alloc == other.alloc);
+        if (other.chunks != nullptr) {
+            chunk* last = other.chunks;
+            while (last->next != nullptr) last = last->next;
+            last->next = chunks;
+            chunks = other.chunks;
+        }
+        if (other.free_head != nullptr) {
+            other.free_tail->next = free_head;
+            if (free_head == nullptr) free_tail = other.free_tail;
+            free_head = other.free_head;
+        }
+        if (next_chunk_bytes < other.next_chunk_bytes)
+            next_chunk_bytes = other.next_chunk_bytes;
+        other.chunks = nullptr;
+        other.free_head = other.free_tail = nullptr;
+        other.next_chunk_bytes = chunk_bytes(first_chunk_slots);
+    }
+
+    // Zwalnia całą pamięć; węzły muszą być już zniszczone
+    void release() noexcept {
+        while (chunks != nullptr) {
+            chunk* c = chunks;
+            chunks = c->next;
+            byte_traits::deallocate(
+                alloc,
+                std::pointer_traits<typename byte_traits::pointer>::pointer_to(
+                    *reinterpret_cast<char*>(c)),
+                c->bytes);
+        }
+        free_head = free_tail = nullptr;
+        next_chunk_bytes = chunk_bytes(first_chunk_slots);
+    }
+
+    // Alokatory zamieniamy tylko przy propagate_on_container_swap; bez tego
+    // muszą być równe (np. std::pmr::polymorphic_allocator nie da się nawet
+    // przypisać)
+    void swap(node_slab& other) noexcept {
+        using std::swap;
+        swap(chunks, other.chunks);
+        swap(free_head, other.free_head);
+        swap(free_tail, other.free_tail);
+        swap(next_chunk_bytes, other.next_chunk_bytes);
+        swap_allocators(other, propagate_on_swap());
+    }
+
+   private:
+    void swap_allocators(node_slab& other, std::true_type) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+    }
+    void swap_allocators(node_slab& other, std::false_type) noexcept {
+        assert(alloc == other.alloc);
+        static_cast<void>(other);
+    }
+};
+
+// Wspólna kopia klucza albo wartości; refs to liczba węzłów, które z niej
+// korzystają. Kolejka nie jest współdzielona między wątkami, więc licznik
+// nie musi być atomowy.
+template <typename T>
+struct interned {
+    T object;
+    std::uint32_t refs;
+
+    explicit interned(const T& object) : object(object), refs(1) {}
+};
+
+// Małe, trywialnie kopiowalne obiekty (np. int) nie mają sensu jako
+// wspólne kopie - są nie większe od uchwytu, a kopiuje się je za darmo
+template <typename T>
+struct store_inline
+    : std::integral_constant<bool, std::is_trivially_copyable<T>::value &&
+                                       sizeof(T) <= sizeof(void*)> {};
+
+// Pula wspólnych kopii obiektów typu T (kluczy albo wartości kolejki).
+// Węzły trzymają uchwyty zamiast samych obiektów, więc węzły z równymi
+// kluczami (wartościami) mogą korzystać z jednej kopii; kopia żyje, dopóki
+// korzysta z niej któryś węzeł. Uchwyt to wskaźnik na kopię - porównanie
+// węzłów nie potrzebuje żadnego przeliczania uchwytu.
+template <typename T, typename Alloc, bool Inline = store_inline<T>::value>
+class intern_pool {
+    using record = interned<T>;
+
+    node_slab<record, Alloc> slab;
+
+   public:
+    using handle = record*;
+    // Odpowiedniki uchwytów innej puli (dla copy)
+    using copy_memo = scratch_map<const record*, record*, Alloc>;
+
+    // czy warto szukać kopii do współdzielenia
+    static constexpr bool shared = true;
+
+    explicit intern_pool(const Alloc& alloc = Alloc()) noexcept
+        : slab(alloc) {}
+
+    static const T& get(const handle& h) noexcept { return h->object; }
+
+    // Nowa kopia object [O(1) zamortyzowane]; jeśli alokacja albo
+    // konstruktor kopiujący T rzuci, nic się nie zmienia
+    handle acquire(const T& object) {
+        void* p = slab.allocate();
+        try {
+            return new (p) record(object);
+        } catch (...) {
+            slab.deallocate(p);
+            throw;
+        }
+    }
+
+    // Kolejny węzeł korzysta z kopii h [O(1)]; false (i nic się nie
+    // zmienia), gdy licznik jest już pełny
+    static bool share(handle h) noexcept {
+        if (h->refs == std::numeric_limits<std::uint32_t>::max()) return false;
+        ++h->refs;
+        return true;
+    }
+
+    // Czy z kopii h korzysta tylko jeden węzeł [O(1)]
+    static bool sole(handle h) noexcept { return h->refs == 1; }
+    // Kopia h do przeniesienia; wolno tylko przy sole(h), a potem h trzeba
+    // zwolnić (release)
+    static T& steal(handle h) noexcept { return h->object; }
+
+    // Węzeł przestaje korzystać z kopii h; ostatni ją niszczy [O(1)]
+    void release(handle h) noexcept {
+        if (--h->refs > 0) return;
+        h->~record();
+        slab.deallocate(h);
+    }
+
+    copy_memo make_memo() const {
+        return copy_memo(0, std::hash<const record*>(),
+                         std::equal_to<const record*>(),
+                         slab.get_allocator());
+    }
+
+    // Odpowiednik uchwytu h innej puli [O(1) oczekiwane]: przy pierwszym
+    // wywołaniu dla h nowa kopia, przy kolejnych ta sama. Jeśli coś rzuci,
+    // nic się nie zmienia (poza ewentualnym wpisem w memo).
+    handle copy(handle h, copy_memo& memo) {
+        record*& twin = memo[h];
+        if (twin != nullptr && share(twin)) return twin;
+        twin = acquire(h->object);
+        return twin;
+    }
+
+    void splice(intern_pool& other) noexcept { slab.splice(other.slab); }
+    void swap(intern_pool& other) noexcept { slab.swap(other.slab); }
+};
+
+// Wersja dla małych typów: uchwyt to sam obiekt, trzymany w węźle. Nie ma
+// pamięci, liczników ani wyszukiwania kopii - każda operacja to kopia T
+// albo nic.
+template <typename T, typename Alloc>
+class intern_pool<T, Alloc, true> {
+   public:
+    using handle = T;
+    struct copy_memo {};
+
+    static constexpr bool shared = false;
+
+    explicit intern_pool(const Alloc& = Alloc()) noexcept {}
+
+    static const T& get(const handle& h) noexcept { return h; }
+    static handle acquire(const T& object) noexcept { return object; }
+    static bool share(const handle&) noexcept { return true; }
+    static bool sole(const handle&) noexcept { return true; }
+    static T& steal(handle& h) noexcept { return h; }
+    static void release(const handle&) noexcept {}
+    static copy_memo make_memo() noexcept { return copy_memo(); }
+    static handle copy(const handle& h, copy_memo&) noexcept { return h; }
+    void splice(intern_pool&) noexcept {}
+    void swap(intern_pool&) noexcept {}
+};
+
+template <typename Node>
+struct tree_hook {
+    Node* parent = nullptr;
+    Node* left = nullptr;
+    Node* right = nullptr;
+};
+
+// Rozszerzenie drzewa (np. rozmiar poddrzewa): Augment::pull(n) przelicza
+// dane węzła n z danych jego dzieci, a join(n, m) i leave(n, m) poprawiają
+// je, gdy do poddrzewa n doszedł albo z niego odszedł sam węzeł m - tak
+// przodków nie trzeba przeliczać od dzieci, które nie leżą na ścieżce.
+// Drzewa bez rozszerzenia nic nie liczą.
+struct no_augment {
+    static constexpr bool enabled = false;
+    template <typename Node>
+    static void pull(Node*) noexcept {}
+    template <typename Node>
+    static void join(Node*, const Node*) noexcept {}
+    template <typename Node>
+    static void leave(Node*, const Node*) noexcept {}
+};
+
+// Liczba par w poddrzewie węzła - pole jest tylko w drzewach, które ją
+// liczą (RankedTreeBackend), pozostałe nie płacą za nie pamięcią
+template <typename Size, bool Enabled>
+struct subtree_weight_field {
+    Size weight = 1;
+};
+
+template <typename Size>
+struct subtree_weight_field<Size, false> {};
+
+// Drzewo BST z kopcem po priorytetach (treap) splecione z węzłami: węzeł
+// zawiera po jednym haku (tree_hook) na każde drzewo, do którego należy,
+// a drzewo wskazuje hak przez Hook. Drzewo nie zna porządku węzłów
+// (wyszukiwanie dostaje komparator od wywołującego), nie alokuje, a poza
+// wyszukiwaniem nie rzuca wyjątków. Węzeł musi mieć pole priority.
+// Augment (np. no_augment) dostaje pull dla węzłów przestawionych rotacją
+// i przy budowie, a join i leave dla przodków dowiązanego i odwiązanego
+// węzła.
+template <typename Node, tree_hook<Node> Node::*Hook,
+          typename Augment = no_augment>
+class treap {
+   public:
+    Node* root = nullptr;
+    Node* first = nullptr;
+    Node* last = nullptr;
+
+    static tree_hook<Node>& hook(Node* n) noexcept { return n->*Hook; }
+    static const tree_hook<Node>& hook(const Node* n) noexcept {
+        return n->*Hook;
+    }
+
+    static Node* leftmost(Node* n) noexcept {
+        while (hook(n).left != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            n = hook(n).left;
+        }
+        return n;
+    }
+    static Node* rightmost(Node* n) noexcept {
+        while (hook(n).right != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            n = hook(n).right;
+        }
+        return n;
+    }
+
+    // Następnik i poprzednik w porządku drzewa [O(log size) pesymistycznie,
+    // O(1) zamortyzowane przy przechodzeniu całego drzewa]
+    static Node* next(Node* n) noexcept {
+        PRIORITY_QUEUE_COUNT(nodes, 1);
+        if (hook(n).right != nullptr) return leftmost(hook(n).right);
+        Node* p = hook(n).parent;
+        while (p != nullptr && hook(p).right == n) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            n = p;
+            p = hook(p).parent;
+        }
+        return p;
+    }
+    static Node* prev(Node* n) noexcept {
+        PRIORITY_QUEUE_COUNT(nodes, 1);
+        if (hook(n).left != nullptr) return rightmost(hook(n).left);
+        Node* p = hook(n).parent;
+        while (p != nullptr && hook(p).left == n) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            n = p;
+            p = hook(p).parent;
+        }
+        return p;
+    }
+
+    bool empty() const noexcept { return root == nullptr; }
+
+    // Wyszukiwanie: less(probe, węzeł) i less(węzeł, probe) porównują probe
+    // z węzłem w porządku drzewa; tylko te metody drzewa mogą rzucić
+
+    // Miejsce (liść pod parent) za wszystkimi węzłami równoważnymi probe
+    // [O(log size)]
+    template <typename Probe, typename Less>
+    void upper_bound_position(const Probe& probe, Less less, Node*& parent,
+                              bool& left) const {
+        Node* n = root;
+        parent = nullptr;
+        left = false;
+        while (n != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            parent = n;
+            left = less(probe, *n);
+            n = left ? hook(n).left : hook(n).right;
+        }
+    }
+
+    // Dowolny węzeł równoważny probe albo nullptr [O(log size)]
+    template <typename Probe, typename Less>
+    Node* find(const Probe& probe, Less less) const {
+        Node* n = root;
+        while (n != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            if (less(probe, *n))
+                n = hook(n).left;
+            else if (less(*n, probe))
+                n = hook(n).right;
+            else
+                return n;
+        }
+        return nullptr;
+    }
+
+    // Dowiązuje n jako liść pod parent (jako lewe dziecko gdy left) i
+    // przywraca porządek kopca [O(log size)]
+    void link(Node* n, Node* parent, bool left) noexcept {
+        PRIORITY_QUEUE_COUNT(nodes, 1);
+        tree_hook<Node>& h = hook(n);
+        h.parent = parent;
+        h.left = h.right = nullptr;
+        if (parent == nullptr) {
+            assert(root == nullptr);
+            root = first = last = n;
+            Augment::pull(n);
+            return;
+        }
+        if (left) {
+            assert(hook(parent).left == nullptr);
+            hook(parent).left = n;
+            if (parent == first) first = n;
+        } else {
+            assert(hook(parent).right == nullptr);
+            hook(parent).right = n;
+            if (parent == last) last = n;
+        }
+        Augment::pull(n);
+        while (h.parent != nullptr && h.parent->priority < n->priority)
+            rotate_up(n);
+        if (Augment::enabled)
+            for (Node* p = h.parent; p != nullptr; p = hook(p).parent)
+                Augment::join(p, n);
+    }
+
+    // Dowiązuje n tuż przed hint (na końcu, gdy hint == nullptr)
+    void link_before(Node* n, Node* hint) noexcept {
+        if (hint == nullptr) {
+            link(n, last, false);
+        } else if (hook(hint).left == nullptr) {
+            link(n, hint, true);
+        } else {
+            link(n, rightmost(hook(hint).left), false);
+        }
+    }
+
+    // Dowiązuje n w miejscu (parent, left) wyznaczonym przed ostatnimi
+    // zmianami drzewa; jeśli to miejsce jest już zajęte, to tuż przed parent
+    // (left) albo tuż za nim - kolejność w drzewie jest ta sama
+    void link_at(Node* n, Node* parent, bool left) noexcept {
+        Node* child = left ? hook(parent).left : hook(parent).right;
+        if (child == nullptr)
+            link(n, parent, left);
+        else if (left)
+            link(n, rightmost(child), false);
+        else
+            link(n, leftmost(child), true);
+    }
+
+    // Przepina n w miejsce (parent, left) wyznaczone, gdy n był jeszcze
+    // w drzewie (parent może być samym n) [O(log size)]
+    void relink(Node* n, Node* parent, bool left) noexcept {
+        if (parent == n) {
+            // miejsce tuż obok n - po odpięciu n jest przed jego następnikiem
+            Node* before = next(n);
+            unlink(n);
+            link_before(n, before);
+        } else {
+            unlink(n);
+            link_at(n, parent, left);
+        }
+    }
+
+    // Odwiązuje n z drzewa [O(log size)]
+    void unlink(Node* n) noexcept {
+        PRIORITY_QUEUE_COUNT(nodes, 1);
+        if (n == first) first = next(n);
+        if (n == last) last = prev(n);
+
+        tree_hook<Node>& h = hook(n);
+        while (h.left != nullptr && h.right != nullptr) {
+            if (h.left->priority < h.right->priority)
+                rotate_up(h.right);
+            else
+                rotate_up(h.left);
+        }
+        Node* child = (h.left != nullptr) ? h.left : h.right;
+        replace_child(h.parent, n, child);
+        if (child != nullptr) hook(child).parent = h.parent;
+        if (Augment::enabled)
+            for (Node* p = h.parent; p != nullptr; p = hook(p).parent)
+                Augment::leave(p, n);
+        h.parent = h.left = h.right = nullptr;
+    }
+
+    // Buduje drzewo od nowa z węzłów podanych (jako wskaźniki) w porządku
+    // drzewa [O(n)]; kształt wyznaczają priorytety węzłów. Prawy grzbiet
+    // budowanego drzewa przechodzimy wskaźnikami parent, więc nie potrzeba
+    // dodatkowej pamięci.
+    template <typename It>
+    void build(It begin, It end) noexcept {
+        clear();
+        Node* top = nullptr;
+        for (; begin != end; ++begin) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            Node* n = *begin;
+            Node* below = nullptr;
+            Node* t = top;
+            while (t != nullptr && t->priority < n->priority) {
+                PRIORITY_QUEUE_COUNT(nodes, 1);
+                below = t;
+                t = hook(t).parent;
+            }
+            tree_hook<Node>& h = hook(n);
+            h.left = below;
+            if (below != nullptr) hook(below).parent = n;
+            h.right = nullptr;
+            h.parent = t;
+            if (t != nullptr)
+                hook(t).right = n;
+            else
+                root = n;
+            if (first == nullptr) first = n;
+            last = top = n;
+        }
+        if (Augment::enabled) refresh_all();
+    }
+
+    void clear() noexcept { root = first = last = nullptr; }
+
+    void swap(treap& other) noexcept {
+        std::swap(root, other.root);
+        std::swap(first, other.first);
+        std::swap(last, other.last);
+    }
+
+   private:
+    void replace_child(Node* parent, Node* old_child,
+                       Node* new_child) noexcept {
+        if (parent == nullptr)
+            root = new_child;
+        else if (hook(parent).left == old_child)
+            hook(parent).left = new_child;
+        else
+            hook(parent).right = new_child;
+    }
+
+    // Rotacja podnosząca n o jeden poziom
+    void rotate_up(Node* n) noexcept {
+        PRIORITY_QUEUE_COUNT(nodes, 1);
+        tree_hook<Node>& h = hook(n);
+        Node* p = h.parent;
+        tree_hook<Node>& ph = hook(p);
+        Node* g = ph.parent;
+        if (ph.left == n) {
+            ph.left = h.right;
+            if (h.right != nullptr) hook(h.right).parent = p;
+            h.right = p;
+        } else {
+            ph.right = h.left;
+            if (h.left != nullptr) hook(h.left).parent = p;
+            h.left = p;
+        }
+        ph.parent = n;
+        h.parent = g;
+        replace_child(g, p, n);
+        Augment::pull(p);
+        Augment::pull(n);
+    }
+
+    // Przelicza rozszerzenie wszystkich węzłów, dzieci przed rodzicami
+    // [O(size)]; przejście wskaźnikami parent, bez dodatkowej pamięci
+    void refresh_all() noexcept {
+        Node* from = nullptr;
+        Node* n = root;
+        while (n != nullptr) {
+            const tree_hook<Node>& h = hook(n);
+            Node* next;
+            if (from == h.parent && h.left != nullptr)
+                next = h.left;
+            else if ((from == h.parent || from == h.left) &&
+                     h.right != nullptr)
+                next = h.right;
+            else {
+                Augment::pull(n);
+                next = h.parent;
+            }
+            from = n;
+            n = next;
+        }
+    }
+};
+
+// Węzły kolejki na kopcu (HeapQueue) razem z indeksem po kluczu (dla
+// changeValue), uzupełnianym leniwie: nowy węzeł czeka na liście pending,
+// powiązanej przez by_key.left i by_key.right, a do drzewa trafia dopiero
+// w flush, więc insert nie porównuje kluczy. Node ma pola by_key, indexed,
+// priority i key oraz konstruktor (klucz, wartość, priorytet); pozostałe
+// pola (miejsce w kopcu) należą do silnika.
+template <typename Node, typename Alloc>
+class lazy_key_index {
+    using key_type = decltype(Node::key);
+    using tree_type = treap<Node, &Node::by_key>;
+
+    struct key_less {
+        static const key_type& key_of(const Node& n) noexcept { return n.key; }
+        static const key_type& key_of(const key_type& key) noexcept {
+            return key;
+        }
+
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const {
+            return compare_less(key_of(lhs), key_of(rhs));
+        }
+    };
+
+    // pamięć na węzły
+    node_slab<Node, Alloc> slab;
+    tree_type tree;
+    Node* pending_head = nullptr;
+    Node* pending_tail = nullptr;
+    unsigned seed = 2463534242u;
+
+    unsigned next_priority() noexcept {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    void erase_pending(Node* n) noexcept {
+        Node* before = n->by_key.left;
+        Node* after = n->by_key.right;
+        if (before != nullptr)
+            before->by_key.right = after;
+        else
+            pending_head = after;
+        if (after != nullptr)
+            after->by_key.left = before;
+        else
+            pending_tail = before;
+    }
+
+    // Przenosi wszystkie węzły z drzewa z powrotem na pending [O(size)]
+    void unindex_all() noexcept {
+        Node* n = tree.root;
+        while (n != nullptr) {
+            if (n->by_key.left != nullptr) {
+                // rotacja w prawo, żeby lewe poddrzewo było puste
+                Node* l = n->by_key.left;
+                n->by_key.left = l->by_key.right;
+                l->by_key.right = n;
+                n = l;
+            } else {
+                Node* r = n->by_key.right;
+                push_pending(n);
+                n = r;
+            }
+        }
+        tree.clear();
+    }
+
+   public:
+    explicit lazy_key_index(const Alloc& alloc) : slab(alloc) {}
+
+    Alloc get_allocator() const noexcept { return slab.get_allocator(); }
+
+    // Nowy węzeł spoza indeksu - wołający odkłada go na pending
+    template <typename K, typename V>
+    Node* create(const K& key, const V& value) {
+        void* p = slab.allocate();
+        try {
+            return new (p) Node(key, value, next_priority());
+        } catch (...) {
+            slab.deallocate(p);
+            throw;
+        }
+    }
+
+    void destroy(Node* n) noexcept {
+        n->~Node();
+        slab.deallocate(n);
+    }
+
+    // [O(1)]
+    void push_pending(Node* n) noexcept {
+        n->indexed = false;
+        n->by_key.parent = nullptr;
+        n->by_key.left = pending_tail;
+        n->by_key.right = nullptr;
+        if (pending_tail != nullptr)
+            pending_tail->by_key.right = n;
+        else
+            pending_head = n;
+        pending_tail = n;
+    }
+
+    // Wstawia do drzewa wszystkie węzły z pending [O(pending * log size)].
+    // Jeśli porównanie rzuci, część węzłów zostaje na liście - zawartość
+    // kolejki się nie zmienia.
+    void flush() {
+        while (pending_head != nullptr) {
+            Node* n = pending_head;
+            Node* parent;
+            bool left;
+            tree.upper_bound_position(*n, key_less(), parent, left);
+            erase_pending(n);
+            n->indexed = true;
+            tree.link(n, parent, left);
+        }
+    }
+
+    // Dowolny węzeł z kluczem key albo nullptr; tylko wśród węzłów z drzewa,
+    // więc zwykle po flush [O(log size)]
+    Node* find(const key_type& key) const { return tree.find(key, key_less()); }
+
+    // Usuwa węzeł z drzewa albo z pending [O(log size) albo O(1)]
+    void unindex(Node* n) noexcept {
+        if (n->indexed)
+            tree.unlink(n);
+        else
+            erase_pending(n);
+    }
+
+    // Wywołuje f(n) dla każdego węzła (kolejność dowolna) [O(size)]
+    template <typename F>
+    void for_each(F f) const {
+        for (Node* n = tree.first; n != nullptr; n = tree_type::next(n)) f(n);
+        for (Node* n = pending_head; n != nullptr; n = n->by_key.right) f(n);
+    }
+
+    // Niszczy wszystkie węzły [O(size)]
+    void destroy_all() noexcept {
+        unindex_all();
+        while (pending_head != nullptr) {
+            Node* n = pending_head;
+            pending_head = n->by_key.right;
+            destroy(n);
+        }
+        pending_tail = nullptr;
+    }
+
+    // Przejmuje węzły other (z pamięcią) na koniec pending [O(other.size),
+    // a dla samych węzłów z pending O(1)]; alokatory muszą być równe
+    void splice(lazy_key_index& other) noexcept {
+        other.unindex_all();
+        if (other.pending_head != nullptr) {
+            other.pending_head->by_key.left = pending_tail;
+            if (pending_tail != nullptr)
+                pending_tail->by_key.right = other.pending_head;
+            else
+                pending_head = other.pending_head;
+            pending_tail = other.pending_tail;
+        }
+        slab.splice(other.slab);
+        other.pending_head = other.pending_tail = nullptr;
+    }
+
+    // [O(1)]; alokatory jak w node_slab
+    void swap(lazy_key_index& other) noexcept {
+        slab.swap(other.slab);
+        tree.swap(other.tree);
+        std::swap(pending_head, other.pending_head);
+        std::swap(pending_tail, other.pending_tail);
+        std::swap(seed, other.seed);
+    }
+};
+
+// Zamiany w tablicy kopca wykonane w trakcie jednej naprawy, żeby dało się
+// je cofnąć, gdy porównanie rzuci. Capacity ogranicza liczbę zamian jednej
+// naprawy. Tablica trzyma wskaźniki na węzły z polem slot (pozycją węzła).
+template <std::size_t Capacity>
+class swap_journal {
+    std::size_t from[Capacity];
+    std::size_t to[Capacity];
+    unsigned count = 0;
+
+   public:
+    // Zamienia węzły z pozycji i oraz j, nie zapisując zamiany
+    template <typename Heap>
+    static void swap_slots(Heap& heap, std::size_t i, std::size_t j) noexcept {
+        std::swap(heap[i], heap[j]);
+        heap[i]->slot = i;
+        heap[j]->slot = j;
+    }
+
+    template <typename Heap>
+    void swap(Heap& heap, std::size_t i, std::size_t j) noexcept {
+        swap_slots(heap, i, j);
+        from[count] = i;
+        to[count] = j;
+        ++count;
+    }
+
+    // Cofa zapisane zamiany w odwrotnej kolejności
+    template <typename Heap>
+    void undo(Heap& heap) noexcept {
+        while (count > 0) {
+            --count;
+            swap_slots(heap, from[count], to[count]);
+        }
+    }
+};
+
+}  // namespace priority_queue_detail
+
+// Silniki (backendy) kolejki wybierane trzecim parametrem szablonu.
+// TreeBackend - dwa drzewa (po wartości i po kluczu), wszystkie operacje;
+// RankedTreeBackend - to samo, a dodatkowo rank, nth_by_value
+// i count_in_range w O(log size()) (każda zmiana kolejki poprawia liczniki
+// na ścieżce do korzenia, więc pozostałe operacje są nieco wolniejsze);
+// pozostałe silniki są w osobnych nagłówkach (np. minmaxheap.hh).
+struct TreeBackend {};
+struct RankedTreeBackend {};
+
+// Kolejki na kopcach, w których każda wstawiona para ma własny węzeł
+// (np. pairingheap.hh): równych par nie scalają w jeden węzeł z licznikiem,
+// bo wymagałoby to wyszukiwania przy insert. Mają metody PriorityQueue, ale
+// nie spełniają jej wymogu jednej kopii pary, więc są osobnym szablonem.
+template <typename K, typename V, typename Backend,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+class HeapQueue;
+
+// Czy silnik działa z HeapQueue; specjalizują to nagłówki silników
+template <typename Backend>
+struct is_heap_backend : std::false_type {};
+
+// Alloc przydziela pamięć na węzły (razem z kopiami kluczy i wartości)
+// i na pomocnicze kontenery; kolejka przepina go na potrzebne typy. Pamięć
+// węzłów należy do kolejki razem z alokatorem, więc merge kolejek z różnymi
+// alokatorami kopiuje węzły, a swap takich kolejek wymaga
+// propagate_on_container_swap (jak w kontenerach standardowych).
+// CompareK i CompareV porządkują klucze i wartości (domyślnie operator<),
+// np. std::greater<V> odwraca kolejkę, a komparator porównujący jedno pole
+// struktury porządkuje według tego pola. Operator() komparatora musi być
+// const; pary równoważne w tym porządku kolejka traktuje jak równe (trzyma
+// je w jednym węźle z licznikiem). Komparatory kopiuje się razem z kolejką;
+// merge zostawia *this jego komparatory, a pary kolejki z innym porządkiem
+// wstawia od nowa (komparatory ze stanem uznajemy za równe tylko wtedy, gdy
+// mają operator== i są równe). Tylko silniki
+// drzewiaste (TreeBackend i RankedTreeBackend) przyjmują komparatory inne
+// niż domyślne.
+template <typename K, typename V, typename Backend = TreeBackend,
+          typename Alloc = std::allocator<std::pair<const K, V>>,
+          typename CompareK = priority_queue_detail::default_less<K>,
+          typename CompareV = priority_queue_detail::default_less<V>>
+class PriorityQueue
+    : private priority_queue_detail::compare_holder<CompareK, 0>,
+      private priority_queue_detail::compare_holder<CompareV, 1> {
+    static_assert(std::is_same<Backend, TreeBackend>::value ||
+                      std::is_same<Backend, RankedTreeBackend>::value,
+                  "unknown PriorityQueue backend (missing #include? heap "
+                  "backends like PairingHeapBackend work with HeapQueue), or "
+                  "custom comparators with a backend other than TreeBackend "
+                  "or RankedTreeBackend");
+
+    // czy węzły sorted_by_value liczą pary w swoich poddrzewach
+    static constexpr bool ranked =
+        std::is_same<Backend, RankedTreeBackend>::value;
+
    public:
     using key_type = K;
     using value_type = V;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+    using key_compare = CompareK;
+    using value_compare = CompareV;
 
    protected:
-    using key_ptr = std::shared_ptr<K>;
-    using value_ptr = std::shared_ptr<V>;
-    using element = std::pair<key_ptr, value_ptr>;
+    using alloc_traits = std::allocator_traits<Alloc>;
 
-    template <class Compare = std::less<element>>
-    using element_set = std::multiset<element, Compare>;
+    using key_pool_type = priority_queue_detail::intern_pool<K, Alloc>;
+    using value_pool_type = priority_queue_detail::intern_pool<V, Alloc>;
+    using key_handle = typename key_pool_type::handle;
+    using value_handle = typename value_pool_type::handle;
 
-   public:
-    using size_type = typename element_set<>::size_type;
+    // Jeden węzeł na każdą różną parę (klucz, wartość); powtórzenia pary są
+    // zliczane w count. Klucz i wartość siedzą w pulach kopii (key_pool,
+    // value_pool), a węzeł trzyma tylko uchwyty - węzły z równymi kluczami
+    // albo wartościami korzystają zwykle z jednej kopii. Małe, trywialnie
+    // kopiowalne K i V (store_inline) węzeł trzyma bezpośrednio.
+    // Przy RankedTreeBackend węzeł ma też weight - liczbę par (razem
+    // z powtórzeniami) w swoim poddrzewie w sorted_by_value.
+    struct node : priority_queue_detail::subtree_weight_field<size_type,
+                                                              ranked> {
+        priority_queue_detail::tree_hook<node> by_value;
+        priority_queue_detail::tree_hook<node> by_key;
+        unsigned priority;
+        size_type count;
+        key_handle key;
+        value_handle value;
 
-   protected:
-    // Komparatory
-    class KeyComparer {
-       public:
-        bool operator()(const key_ptr& lhs, const key_ptr& rhs) {
-            return *lhs < *rhs;
+        node(key_handle key, value_handle value, unsigned priority) noexcept
+            : priority(priority), count(1), key(key), value(value) {}
+    };
+
+    // Statystyki pozycyjne sorted_by_value (RankedTreeBackend): pozycję
+    // pary i parę na danej pozycji wyznaczamy jednym zejściem po wagach
+    // poddrzew. grow i shrink poprawiają wagi węzła i jego przodków po
+    // zmianie liczby powtórzeń pary w węźle.
+    struct subtree_weight {
+        static constexpr bool enabled = true;
+        static size_type of(const node* n) noexcept {
+            return n != nullptr ? n->weight : 0;
+        }
+        static void pull(node* n) noexcept {
+            n->weight = n->count + of(n->by_value.left) + of(n->by_value.right);
+        }
+        static void join(node* n, const node* m) noexcept {
+            n->weight += m->count;
         }
+        static void leave(node* n, const node* m) noexcept {
+            n->weight -= m->count;
+        }
+        static void grow(node* n, size_type count) noexcept {
+            for (; n != nullptr; n = n->by_value.parent) n->weight += count;
+        }
+        static void shrink(node* n) noexcept {
+            for (; n != nullptr; n = n->by_value.parent) --n->weight;
+        }
+        static void copy(node* twin, const node* n) noexcept {
+            twin->weight = n->weight;
+        }
+    };
+
+    // Bez statystyk pozycyjnych (TreeBackend) nic nie liczymy
+    struct no_weight : priority_queue_detail::no_augment {
+        static void grow(node*, size_type) noexcept {}
+        static void shrink(node*) noexcept {}
+        static void copy(node*, const node*) noexcept {}
+    };
+
+    using weight_policy =
+        typename std::conditional<ranked, subtree_weight, no_weight>::type;
+
+    // Para podana przez użytkownika - pozwala szukać w drzewach bez
+    // tworzenia węzła ani kopiowania klucza i wartości
+    struct element_ref {
+        const K& key;
+        const V& value;
     };
 
-    class ValueComparer {
+    static const K& key_of(const node& n) noexcept {
+        return key_pool_type::get(n.key);
+    }
+    static const K& key_of(const element_ref& e) noexcept { return e.key; }
+    static const K& key_of(const K& key) noexcept { return key; }
+    static const V& value_of(const node& n) noexcept {
+        return value_pool_type::get(n.value);
+    }
+    static const V& value_of(const element_ref& e) noexcept { return e.value; }
+    static const V& value_of(const V& value) noexcept { return value; }
+
+    using key_compare_holder =
+        priority_queue_detail::compare_holder<CompareK, 0>;
+    using value_compare_holder =
+        priority_queue_detail::compare_holder<CompareV, 1>;
+
+    // Komparatory (heterogeniczne: porównują węzły z surowymi K i parami);
+    // trzymają kopie komparatorów kolejki - puste nic nie kosztują
+    class KeyComparer {
        public:
-        bool operator()(const value_ptr& lhs, const value_ptr& rhs) {
-            return *lhs < *rhs;
+        using is_transparent = void;
+
+        explicit KeyComparer(const CompareK& key_less) : key_less(key_less) {}
+
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const {
+            return priority_queue_detail::compare_with(key_less, key_of(lhs),
+                                                        key_of(rhs));
         }
+
+       private:
+        CompareK key_less;
     };
 
     class ValueKeyComparer {
        public:
-        bool operator()(const element& lhs, const element& rhs) {
-            if (*(lhs.second) < *(rhs.second)) return true;
-            if (*(rhs.second) < *(lhs.second)) return false;
-            return *(lhs.first) < *(rhs.first);
+        using is_transparent = void;
+
+        ValueKeyComparer(const CompareV& value_less, const CompareK& key_less)
+            : value_less(value_less), key_less(key_less) {}
+
+        // Tylko wartości (bez rozstrzygania kluczem)
+        template <typename L, typename R>
+        bool values(const L& lhs, const R& rhs) const {
+            return priority_queue_detail::compare_with(
+                value_less, value_of(lhs), value_of(rhs));
+        }
+
+        template <typename L, typename R>
+        bool operator()(const L& lhs, const R& rhs) const {
+            using priority_queue_detail::compare_with;
+            if (values(lhs, rhs)) return true;
+            if (values(rhs, lhs)) return false;
+            return compare_with(key_less, key_of(lhs), key_of(rhs));
         }
+
+       private:
+        CompareV value_less;
+        CompareK key_less;
     };
 
+    KeyComparer key_comparer() const { return KeyComparer(key_comp_ref()); }
+    ValueKeyComparer value_key_comparer() const {
+        return ValueKeyComparer(value_comp_ref(), key_comp_ref());
+    }
+    const CompareK& key_comp_ref() const noexcept {
+        return key_compare_holder::get();
+    }
+    const CompareV& value_comp_ref() const noexcept {
+        return value_compare_holder::get();
+    }
+    static constexpr bool nothrow_compare_copy() noexcept {
+        return std::is_nothrow_copy_constructible<CompareK>::value &&
+               std::is_nothrow_copy_constructible<CompareV>::value;
+    }
+
    protected:
-    using elements = element_set<ValueKeyComparer>;
-    using value_map = std::map<value_ptr, element_set<>, ValueComparer>;
-    using key_map = std::map<key_ptr, value_map, KeyComparer>;
-    using value_set = std::multiset<value_ptr, ValueComparer>;
+    template <typename T>
+    using scratch_vector = priority_queue_detail::scratch_vector<T, Alloc>;
+    template <typename Key, typename T>
+    using scratch_map = priority_queue_detail::scratch_map<Key, T, Alloc>;
+
+    using slab_type = priority_queue_detail::node_slab<node, Alloc>;
+    using value_index =
+        priority_queue_detail::treap<node, &node::by_value, weight_policy>;
+    using key_index = priority_queue_detail::treap<node, &node::by_key>;
 
+    // pamięć na węzły
+    slab_type slab;
+    // wspólne kopie kluczy i wartości
+    key_pool_type key_pool;
+    value_pool_type value_pool;
     // sortowanie po wartości, a potem po kluczu
-    elements sorted_by_value;
-    // sortowanie po kluczu, a potem po wartości, a na koniec po adresach
-    key_map sorted_by_key;
-    // set z wartoścami trzymanymi w kolejce
-    value_set all_values;
+    value_index sorted_by_value;
+    // sortowanie po kluczu (równe klucze w kolejności wstawienia)
+    key_index sorted_by_key;
+    // liczba par razem z powtórzeniami
+    size_type total = 0;
+    // największa dozwolona liczba par (set_capacity)
+    size_type limit = std::numeric_limits<size_type>::max();
+    // stan generatora priorytetów węzłów (xorshift)
+    unsigned seed = 2463534242u;
+#ifdef PRIORITY_QUEUE_STATS
+    // liczniki należą do obiektu - nie są kopiowane ani zamieniane
+    mutable PriorityQueueStats statistics;
+#endif
 
    protected:
-    element find_element(const key_ptr& k, const value_ptr& v) {
-        auto kit = sorted_by_key.find(k);
-        auto vit = all_values.find(v);
+    unsigned next_priority() noexcept {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+    // Tworzy niepodpięty węzeł z uchwytami key i value, które przejmuje
+    // (jeśli alokacja rzuci, zwalnia je)
+    node* create_node_from_handles(key_handle key, value_handle value) {
+        void* p;
+        try {
+            p = slab.allocate();
+        } catch (...) {
+            key_pool.release(key);
+            value_pool.release(value);
+            throw;
+        }
+        return new (p) node(key, value, next_priority());
+    }
+
+    // Tworzy niepodpięty węzeł z parą (key, value). Klucz bierzemy z węzła
+    // key_twin, a wartość z value_twin (o ile nie są nullptr i da się jeszcze
+    // współdzielić ich kopie), w przeciwnym razie kopiujemy; jeśli coś
+    // rzuci, nic się nie zmienia
+    node* create_node(const K& key, const V& value,
+                      const node* key_twin = nullptr,
+                      const node* value_twin = nullptr) {
+        key_handle k = (key_twin != nullptr && key_pool.share(key_twin->key))
+                           ? key_twin->key
+                           : key_pool.acquire(key);
+        value_handle v;
+        try {
+            v = acquire_value(value, value_twin);
+        } catch (...) {
+            key_pool.release(k);
+            throw;
+        }
+        return create_node_from_handles(k, v);
+    }
+
+    // Uchwyt wartości value: kopia z węzła twin, o ile nie jest nullptr
+    // i da się ją jeszcze współdzielić, w przeciwnym razie nowa kopia
+    value_handle acquire_value(const V& value, const node* twin) {
+        return (twin != nullptr && value_pool.share(twin->value))
+                   ? twin->value
+                   : value_pool.acquire(value);
+    }
+
+    void destroy_node(node* n) noexcept {
+        key_pool.release(n->key);
+        value_pool.release(n->value);
+        n->~node();
+        slab.deallocate(n);
+    }
+
+    // Sąsiad miejsca (parent, left) w sorted_by_key z kluczem równoważnym
+    // key albo nullptr [O(log size()), jedno porównanie]; miejsce jest za
+    // wszystkimi równoważnymi kluczami, więc wystarczy sprawdzić poprzednika
+    node* key_twin(const K& key, node* parent, bool left) const {
+        if (!key_pool_type::shared) return nullptr;
+        node* prev = left ? key_index::prev(parent) : parent;
+        if (prev != nullptr && !key_comparer()(*prev, key)) return prev;
+        return nullptr;
+    }
+
+    // Sąsiad miejsca (parent, left) w sorted_by_value z wartością
+    // równoważną value albo nullptr [O(log size()), do dwóch porównań]
+    node* value_twin(const V& value, node* parent, bool left) const {
+        if (!value_pool_type::shared || parent == nullptr) return nullptr;
+        ValueKeyComparer less = value_key_comparer();
+        node* prev = left ? value_index::prev(parent) : parent;
+        if (prev != nullptr && !less.values(*prev, value)) return prev;
+        node* next = left ? parent : value_index::next(parent);
+        if (next != nullptr && !less.values(value, *next)) return next;
+        return nullptr;
+    }
+
+    // Niszczy wszystkie węzły (bez odwiązywania ich z drzew) [O(size())]
+    void destroy_all() noexcept {
+        node* n = sorted_by_value.root;
+        while (n != nullptr) {
+            if (n->by_value.left != nullptr) {
+                // rotacja w prawo, żeby lewe poddrzewo było puste
+                node* l = n->by_value.left;
+                n->by_value.left = l->by_value.right;
+                l->by_value.right = n;
+                n = l;
+            } else {
+                node* r = n->by_value.right;
+                destroy_node(n);
+                n = r;
+            }
+        }
+        sorted_by_value.clear();
+        sorted_by_key.clear();
+        total = 0;
+    }
 
-        auto kk = (kit == sorted_by_key.end()) ? k : (kit->first);
-        auto vv = (vit == all_values.end()) ? v : (*vit);
+    // Szuka w sorted_by_value węzła z parą równoważną parze probe. Jeśli jej
+    // nie ma, zwraca nullptr i ustawia parent/left na miejsce, w którym probe
+    // należy dowiązać [O(log size())]
+    template <typename Probe>
+    node* find_by_value(const Probe& probe, node*& parent, bool& left) const {
+        bool beside;
+        return find_by_value(probe, parent, left, nullptr, beside);
+    }
+
+    // Jak wyżej, a dodatkowo beside mówi, czy miejsce dla probe sąsiaduje
+    // z węzłem near (jest tuż przed nim albo tuż za nim). Takie miejsce leży
+    // w poddrzewie near: ścieżka skręca w near w jedną stronę, a dalej już
+    // tylko w przeciwną.
+    template <typename Probe>
+    node* find_by_value(const Probe& probe, node*& parent, bool& left,
+                        const node* near, bool& beside) const {
+        ValueKeyComparer less = value_key_comparer();
+        node* n = sorted_by_value.root;
+        parent = nullptr;
+        left = false;
+        bool below_near = false, turn = false;
+        beside = false;
+        while (n != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            if (less(probe, *n))
+                left = true;
+            else if (less(*n, probe))
+                left = false;
+            else
+                return n;
+            if (n == near) {
+                below_near = beside = true;
+                turn = left;
+            } else if (below_near && left == turn) {
+                beside = false;
+            }
+            parent = n;
+            n = left ? n->by_value.left : n->by_value.right;
+        }
+        return nullptr;
+    }
 
-        return make_pair(kk, vv);
+    // Miejsce w sorted_by_key za wszystkimi węzłami o kluczu równoważnym
+    // kluczowi probe [O(log size())]
+    template <typename Probe>
+    void find_key_position(const Probe& probe, node*& parent,
+                           bool& left) const {
+        sorted_by_key.upper_bound_position(probe, key_comparer(), parent, left);
     }
-    element find_element(const K& key, const V& value) {
-        auto k = std::make_shared<K>(key);
-        auto v = std::make_shared<V>(value);
 
-        return find_element(k, v);
+    // Dowolny węzeł o kluczu równoważnym kluczowi probe albo nullptr
+    // [O(log size())]
+    template <typename Probe>
+    node* find_by_key(const Probe& probe) const {
+        return sorted_by_key.find(probe, key_comparer());
+    }
+
+    // Węzeł o kluczu równoważnym key, w którym zostały pary niezaznaczone
+    // w taken, albo nullptr [O(log size()) plus liczba przejrzanych węzłów
+    // o tym kluczu]
+    node* find_spare_by_key(
+        const K& key,
+        const scratch_map<node*, size_type>& taken) const {
+        auto spare = [&taken](node* n) {
+            auto it = taken.find(n);
+            return it == taken.end() || it->second < n->count;
+        };
+        KeyComparer key_less = key_comparer();
+        node* n = find_by_key(key);
+        if (n == nullptr || spare(n)) return n;
+        for (node* m = key_index::next(n);
+             m != nullptr && !key_less(key, *m); m = key_index::next(m))
+            if (spare(m)) return m;
+        for (node* m = key_index::prev(n);
+             m != nullptr && !key_less(*m, key); m = key_index::prev(m))
+            if (spare(m)) return m;
+        return nullptr;
+    }
+
+    // Wstawia count powtórzeń pary (key, value) [O(log size())]
+    // Najpierw szukamy pary bez kopiowania - węzeł tworzymy tylko wtedy, gdy
+    // takiej pary jeszcze nie ma, a key i value kopiujemy tylko wtedy, gdy
+    // sąsiedzi nowego węzła w drzewach nie mają już równego klucza
+    // (wartości). Silna gwarancja: wszystko, co może rzucić (porównania,
+    // alokacja, kopie), dzieje się przed pierwszą modyfikacją drzew
+    void insert_element(const K& key, const V& value, size_type count) {
+        element_ref e{key, value};
+        node* vparent;
+        bool vleft;
+        node* existing = find_by_value(e, vparent, vleft);
+        if (existing != nullptr) {
+            add_repeats(existing, count);
+            total += count;
+            return;
+        }
+
+        node* kparent;
+        bool kleft;
+        find_key_position(e, kparent, kleft);
+
+        node* n = create_node(key, value, key_twin(key, kparent, kleft),
+                              value_twin(value, vparent, vleft));
+        n->count = count;
+        sorted_by_value.link(n, vparent, vleft);
+        sorted_by_key.link(n, kparent, kleft);
+        total += count;
+    }
+
+    // Dodaje count powtórzeń pary do węzła n (i do wag jego przodków
+    // w sorted_by_value) [O(1), O(log size()) z RankedTreeBackend], no-throw
+    static void add_repeats(node* n, size_type count) noexcept {
+        n->count += count;
+        weight_policy::grow(n, count);
+    }
+
+    // Zabiera węzłowi n jedno z co najmniej dwóch powtórzeń pary
+    // [jak add_repeats], no-throw
+    static void drop_repeat(node* n) noexcept {
+        assert(n->count > 1);
+        --n->count;
+        weight_policy::shrink(n);
+    }
+
+    // Usuwa jedno powtórzenie pary z węzła n [O(log size())], no-throw
+    void remove_one(node* n) noexcept {
+        --total;
+        if (n->count > 1) {
+            drop_repeat(n);
+            return;
+        }
+        sorted_by_value.unlink(n);
+        sorted_by_key.unlink(n);
+        destroy_node(n);
+    }
+
+    // Usuwa jedno powtórzenie pary z węzła n i zwraca ją [O(log size())].
+    // Klucz i wartość przenosimy tylko razem - i tylko wtedy, gdy oba
+    // przeniesienia nie rzucają - więc jeśli kopia rzuci, nic się nie
+    // zmienia.
+    std::pair<K, V> pop(node* n) {
+        if (n->count == 1 && key_pool_type::sole(n->key) &&
+            value_pool_type::sole(n->value) &&
+            std::is_nothrow_move_constructible<K>::value &&
+            std::is_nothrow_move_constructible<V>::value) {
+            std::pair<K, V> result(std::move(key_pool_type::steal(n->key)),
+                                   std::move(value_pool_type::steal(n->value)));
+            remove_one(n);
+            return result;
+        }
+        std::pair<K, V> result(key_of(*n), value_of(*n));
+        remove_one(n);
+        return result;
+    }
+
+    // Liczba par o wartości mniejszej niż value (z równymi, gdy inclusive)
+    // [O(log size())]
+    size_type count_below(const V& value, bool inclusive) const {
+        ValueKeyComparer less = value_key_comparer();
+        size_type below = 0;
+        node* n = sorted_by_value.root;
+        while (n != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            if (inclusive ? !less.values(value, *n) : less.values(*n, value)) {
+                below += subtree_weight::of(n->by_value.left) + n->count;
+                n = n->by_value.right;
+            } else {
+                n = n->by_value.left;
+            }
+        }
+        return below;
+    }
+
+    // Usuwa najmniejsze pary ponad limit [O(nadmiar * log size())],
+    // no-throw
+    void trim() noexcept {
+        while (total > limit) remove_one(sorted_by_value.first);
+    }
+
+    // insert do pełnej kolejki: para nie większa niż minimum przepada po
+    // jednym porównaniu, a lepsza zajmuje miejsce minimum. Jeśli minimum
+    // jest w węźle bez powtórzeń, a nowej pary nie ma jeszcze w kolejce,
+    // przepinamy ten węzeł z nowym kluczem i wartością (bez alokacji
+    // węzła). Silna gwarancja jak przy insert_element.
+    void insert_bounded(const K& key, const V& value) {
+        if (empty()) return;  // limit == 0
+        node* worst = sorted_by_value.first;
+        ValueKeyComparer less = value_key_comparer();
+        if (!less.values(*worst, value)) return;
+
+        element_ref e{key, value};
+        node* vparent;
+        bool vleft;
+        node* existing = find_by_value(e, vparent, vleft);
+        if (existing != nullptr || worst->count > 1) {
+            if (existing != nullptr) {
+                add_repeats(existing, 1);
+                ++total;
+            } else {
+                insert_element(key, value, 1);
+            }
+            remove_one(worst);
+            return;
+        }
+
+        node* kparent;
+        bool kleft;
+        find_key_position(e, kparent, kleft);
+        const node* ktwin = key_twin(key, kparent, kleft);
+        key_handle k = (ktwin != nullptr && key_pool.share(ktwin->key))
+                           ? ktwin->key
+                           : key_pool.acquire(key);
+        value_handle v;
+        try {
+            v = acquire_value(value, value_twin(value, vparent, vleft));
+        } catch (...) {
+            key_pool.release(k);
+            throw;
+        }
+        // od tego miejsca nic nie rzuca
+        key_pool.release(worst->key);
+        value_pool.release(worst->value);
+        worst->key = k;
+        worst->value = v;
+        sorted_by_value.relink(worst, vparent, vleft);
+        sorted_by_key.relink(worst, kparent, kleft);
+    }
+
+    // merge bez ograniczenia rozmiaru (changeValues scala partię, a potem
+    // usuwa zmienione pary, więc rozmiar na koniec się nie zmienia)
+    void merge_all(PriorityQueue& queue) {
+        if (this == &queue || queue.empty()) return;
+        if (!(get_allocator() == queue.get_allocator())) {
+            PriorityQueue copy(queue, get_allocator());
+            PriorityQueue emptied(queue.key_comp_ref(), queue.value_comp_ref(),
+                                  queue.get_allocator());
+            merge_all(copy);
+            // queue oddaje pamięć, ale zostaje przy swoim ograniczeniu
+            queue.swap_contents(emptied);
+            return;
+        }
+        if (!same_order(queue)) {
+            // Węzły queue są ułożone w jej porządku - jej pary wstawiamy od
+            // nowa według komparatorów *this [dodatkowo O(queue.size()
+            // log queue.size())]
+            PriorityQueue sorted(key_comp_ref(), value_comp_ref(),
+                                 get_allocator());
+            for (node* n = queue.sorted_by_value.first; n != nullptr;
+                 n = value_index::next(n))
+                sorted.insert_element(key_of(*n), value_of(*n), n->count);
+            merge_ordered(sorted);
+            queue.destroy_all();
+            return;
+        }
+        merge_ordered(queue);
+    }
+
+    // merge_all dla queue z tym samym alokatorem i porządkiem co *this
+    void merge_ordered(PriorityQueue& queue) {
+        if (empty()) {
+            // komparatory i ograniczenia rozmiaru zostają przy kolejkach
+            swap_contents(queue);
+            return;
+        }
+
+        size_type log_size = 0;
+        for (size_type s = total + queue.total; s > 1; s /= 2) ++log_size;
+        if (queue.total * log_size < total)
+            merge_hinted(queue);
+        else
+            merge_linear(queue);
+    }
+
+    // Węzeł queue, który ma już odpowiednik (równą parę) w *this
+    struct merge_duplicate {
+        node* stolen;
+        node* twin;
+    };
+
+    // Węzeł queue i węzeł *this, przed którym trzeba go dowiązać
+    // (nullptr - na końcu)
+    struct merge_hint {
+        node* stolen;
+        node* before;
+    };
+
+    // Przenosi powtórzenia duplikatów do ich bliźniaków w *this; duplikat
+    // zostaje z count == 0 [O(duplicates.size())], no-throw
+    static void move_counts(
+        const scratch_vector<merge_duplicate>& duplicates) noexcept {
+        for (const merge_duplicate& d : duplicates) {
+            add_repeats(d.twin, d.stolen->count);
+            d.stolen->count = 0;
+        }
+    }
+
+    // Przejmuje całą pamięć queue (węzły i kopie kluczy i wartości) razem
+    // z żyjącymi w niej obiektami [O(liczba kawałków pamięci queue)]
+    void adopt_memory(PriorityQueue& queue) noexcept {
+        slab.splice(queue.slab);
+        key_pool.splice(queue.key_pool);
+        value_pool.splice(queue.value_pool);
+    }
+
+    // Czy queue porządkuje pary tak samo jak *this (patrz same_order)
+    bool same_order(const PriorityQueue& queue) const {
+        using priority_queue_detail::same_order;
+        return same_order(key_comp_ref(), queue.key_comp_ref(), 0) &&
+               same_order(value_comp_ref(), queue.value_comp_ref(), 0);
+    }
+
+    // Zamienia pary (razem z pamięcią) z queue; komparatory i ograniczenia
+    // rozmiaru zostają na miejscu [O(1)]
+    void swap_contents(PriorityQueue& queue) noexcept {
+        swap_memory(queue);
+        sorted_by_value.swap(queue.sorted_by_value);
+        sorted_by_key.swap(queue.sorted_by_key);
+        std::swap(total, queue.total);
+        std::swap(seed, queue.seed);
+    }
+
+    // Zamienia całą pamięć z queue [O(1)]
+    void swap_memory(PriorityQueue& queue) noexcept {
+        slab.swap(queue.slab);
+        key_pool.swap(queue.key_pool);
+        value_pool.swap(queue.value_pool);
+    }
+
+    // Przejmuje pamięć queue razem z jej węzłami i niszczy duplikaty
+    // [O(liczba kawałków pamięci queue + duplicates.size())], no-throw
+    void adopt_nodes(
+        PriorityQueue& queue,
+        const scratch_vector<merge_duplicate>& duplicates) noexcept {
+        adopt_memory(queue);
+        for (const merge_duplicate& d : duplicates) destroy_node(d.stolen);
+        total += queue.total;
+        queue.total = 0;
+        queue.sorted_by_value.clear();
+        queue.sorted_by_key.clear();
+    }
+
+    // Scalanie przez jednoczesne przejście obu kolejek w porządku obu drzew
+    // [O(size() + queue.size())]; drzewa *this budujemy od nowa
+    void merge_linear(PriorityQueue& queue) {
+        ValueKeyComparer value_less = value_key_comparer();
+        KeyComparer key_less = key_comparer();
+
+        scratch_vector<merge_duplicate> duplicates(get_allocator());
+        scratch_vector<node*> by_value(get_allocator()),
+            by_key(get_allocator());
+
+        node* a = sorted_by_value.first;
+        node* b = queue.sorted_by_value.first;
+        while (a != nullptr || b != nullptr) {
+            if (b == nullptr || (a != nullptr && value_less(*a, *b))) {
+                by_value.push_back(a);
+                a = value_index::next(a);
+            } else if (a == nullptr || value_less(*b, *a)) {
+                by_value.push_back(b);
+                b = value_index::next(b);
+            } else {
+                duplicates.push_back(merge_duplicate{b, a});
+                b = value_index::next(b);
+            }
+        }
+
+        // Równe klucze z queue trafiają za równe klucze z *this, tak jak
+        // przy insert. Duplikaty odsiewamy przy przepinaniu.
+        a = sorted_by_key.first;
+        b = queue.sorted_by_key.first;
+        while (a != nullptr || b != nullptr) {
+            if (b == nullptr || (a != nullptr && !key_less(*b, *a))) {
+                by_key.push_back(a);
+                a = key_index::next(a);
+            } else {
+                by_key.push_back(b);
+                b = key_index::next(b);
+            }
+        }
+
+        // Od tego miejsca nic nie rzuca
+        move_counts(duplicates);
+        by_key.erase(std::remove_if(by_key.begin(), by_key.end(),
+                                    [](node* n) { return n->count == 0; }),
+                     by_key.end());
+        sorted_by_value.build(by_value.begin(), by_value.end());
+        sorted_by_key.build(by_key.begin(), by_key.end());
+        adopt_nodes(queue, duplicates);
+    }
+
+    // Scalanie przez wyszukanie w *this miejsca dla każdego węzła queue
+    // [O(queue.size() * log (queue.size() + size()))]; węzły queue
+    // dowiązujemy rosnąco przed wyznaczonymi następnikami
+    void merge_hinted(PriorityQueue& queue) {
+        scratch_vector<merge_duplicate> duplicates(get_allocator());
+        scratch_vector<merge_hint> by_value(get_allocator()),
+            by_key(get_allocator());
+
+        for (node* b = queue.sorted_by_value.first; b != nullptr;
+             b = value_index::next(b)) {
+            node* parent;
+            bool left;
+            node* twin = find_by_value(*b, parent, left);
+            if (twin != nullptr)
+                duplicates.push_back(merge_duplicate{b, twin});
+            else
+                by_value.push_back(merge_hint{
+                    b, left ? parent : value_index::next(parent)});
+        }
+        for (node* b = queue.sorted_by_key.first; b != nullptr;
+             b = key_index::next(b)) {
+            node* parent;
+            bool left;
+            find_key_position(*b, parent, left);
+            by_key.push_back(
+                merge_hint{b, left ? parent : key_index::next(parent)});
+        }
+
+        // Od tego miejsca nic nie rzuca
+        move_counts(duplicates);
+        for (const merge_hint& h : by_value)
+            sorted_by_value.link_before(h.stolen, h.before);
+        for (const merge_hint& h : by_key)
+            if (h.stolen->count != 0)
+                sorted_by_key.link_before(h.stolen, h.before);
+        adopt_nodes(queue, duplicates);
+    }
+
+    // Węzeł n korzysta odtąd z kopii klucza (wartości) węzła twin, o ile
+    // da się ją jeszcze współdzielić [O(1)], no-throw
+    void share_key(node* n, const node* twin) noexcept {
+        if (!key_pool.share(twin->key)) return;
+        key_pool.release(n->key);
+        n->key = twin->key;
+    }
+    void share_value(node* n, const node* twin) noexcept {
+        if (!value_pool.share(twin->value)) return;
+        value_pool.release(n->value);
+        n->value = twin->value;
+    }
+
+    // Buduje oba drzewa pustej kolejki z niepodpiętych węzłów nodes
+    // [O(n log n)]; równe pary scalamy w jeden węzeł, a nadmiarowe węzły
+    // niszczymy. Sąsiednie (po sortowaniu) węzły z równymi kluczami albo
+    // wartościami przepinamy na jedną kopię. Jeśli porównanie rzuci,
+    // kolejka zostaje pusta, a węzły dalej należą do wywołującego.
+    void build_from(scratch_vector<node*>& nodes) {
+        ValueKeyComparer value_less = value_key_comparer();
+        KeyComparer key_less = key_comparer();
+
+        std::sort(nodes.begin(), nodes.end(), [&](node* a, node* b) {
+            return value_less(*a, *b);
+        });
+        scratch_vector<node*> by_value(get_allocator());
+        by_value.reserve(nodes.size());
+        for (node* n : nodes) {
+            if (!by_value.empty() && !value_less(*by_value.back(), *n)) {
+                by_value.back()->count += n->count;
+                n->count = 0;
+            } else {
+                if (value_pool_type::shared && !by_value.empty() &&
+                    !value_less.values(*by_value.back(), *n))
+                    share_value(n, by_value.back());
+                by_value.push_back(n);
+            }
+        }
+        // Równe klucze w kolejności wartości; pary są już różne, więc zwykłe
+        // sortowanie daje ten sam wynik co stabilne po kluczu, a nie
+        // potrzebuje bufora spoza alokatora kolejki
+        scratch_vector<node*> by_key(by_value.begin(), by_value.end(),
+                                     get_allocator());
+        std::sort(by_key.begin(), by_key.end(), [&](node* a, node* b) {
+            if (key_less(*a, *b)) return true;
+            if (key_less(*b, *a)) return false;
+            return value_less(*a, *b);
+        });
+        for (size_type i = 1; key_pool_type::shared && i < by_key.size(); ++i)
+            if (!key_less(*by_key[i - 1], *by_key[i]))
+                share_key(by_key[i], by_key[i - 1]);
+
+        // Od tego miejsca nic nie rzuca
+        sorted_by_value.build(by_value.begin(), by_value.end());
+        sorted_by_key.build(by_key.begin(), by_key.end());
+        total = nodes.size();
+        for (node*& n : nodes) {
+            if (n->count == 0) destroy_node(n);
+            n = nullptr;
+        }
+    }
+
+    // Buduje pustą kolejkę z par z zakresu [first, last) [O(n log n)]; jeśli
+    // coś rzuci, kolejka zostaje pusta
+    template <typename InputIt>
+    void build_range(InputIt first, InputIt last) {
+        scratch_vector<node*> nodes(get_allocator());
+        try {
+            for (; first != last; ++first) {
+                nodes.push_back(nullptr);
+                nodes.back() = create_node(first->first, first->second);
+            }
+            build_from(nodes);
+        } catch (...) {
+            for (node* n : nodes)
+                if (n != nullptr) destroy_node(n);
+            throw;
+        }
+    }
+
+    // Partie w insert_many i changeValues pożyczają pule *this (węzłów oraz
+    // kopii kluczy i wartości), więc ich węzły i kopie zajmują wolne miejsca
+    // *this zamiast nowych kawałków pamięci.
+    // Po merge(batch) keep_slab odbiera pulę (merge pustej partii jej nie
+    // przejmuje); jeśli coś rzuci wcześniej, return_slab niszczy węzły
+    // partii i też odbiera pulę.
+    void lend_slab(PriorityQueue& batch) noexcept { swap_memory(batch); }
+    void keep_slab(PriorityQueue& batch) noexcept { adopt_memory(batch); }
+    void return_slab(PriorityQueue& batch) noexcept {
+        batch.destroy_all();
+        keep_slab(batch);
     }
 
    public:
     // Konstruktor bezparametrowy tworzący pustą kolejkę [O(1)]
-    PriorityQueue() = default;
+    PriorityQueue() : PriorityQueue(Alloc()) {}
 
-    // Konstruktor kopiujący [O(queue.size())]
-    // konstruktory kontenerów zapewniają silną gwarancję
-    // jak coś się rzuci, to i tak PriorityQueue się nie utworzy
-    PriorityQueue(const PriorityQueue<K, V>& queue) = default;
+    // Pusta kolejka korzystająca z alokatora alloc [O(1)]
+    explicit PriorityQueue(const Alloc& alloc)
+        : PriorityQueue(CompareK(), CompareV(), alloc) {}
+
+    // Pusta kolejka porządkująca klucze key_less, a wartości value_less
+    // [O(1)]
+    explicit PriorityQueue(const CompareK& key_less,
+                           const CompareV& value_less = CompareV(),
+                           const Alloc& alloc = Alloc())
+        : key_compare_holder(key_less),
+          value_compare_holder(value_less),
+          slab(alloc),
+          key_pool(alloc),
+          value_pool(alloc) {}
 
-    // Konstruktor przenoszący [O(1)]
-    PriorityQueue(PriorityQueue<K, V>&& queue) noexcept
-        : sorted_by_value(std::move(queue.sorted_by_value)),
-          sorted_by_key(std::move(queue.sorted_by_key)),
-          all_values(std::move(queue.all_values)) {}
+    // Konstruktor kopiujący [O(queue.size())]; alokator wybiera
+    // select_on_container_copy_construction, tak jak w kontenerach
+    // biblioteki standardowej
+    PriorityQueue(const PriorityQueue& queue)
+        : PriorityQueue(queue,
+                        alloc_traits::select_on_container_copy_construction(
+                            queue.get_allocator())) {}
+
+    // Kopia queue w pamięci z alokatora alloc [O(queue.size())]
+    // Najpierw kopiujemy wszystkie węzły (to może rzucić - wtedy niszczymy
+    // kopie), potem odtwarzamy kształt obu drzew (no-throw). Każdy klucz
+    // i każdą wartość z puli queue kopiujemy raz, więc kopia współdzieli je
+    // tak samo jak queue.
+    PriorityQueue(const PriorityQueue& queue, const Alloc& alloc)
+        : key_compare_holder(queue.key_comp_ref()),
+          value_compare_holder(queue.value_comp_ref()),
+          slab(alloc),
+          key_pool(alloc),
+          value_pool(alloc),
+          total(queue.total),
+          limit(queue.limit),
+          seed(queue.seed) {
+        PRIORITY_QUEUE_SCOPE(*this, copy);
+        scratch_map<const node*, node*> twins(0, std::hash<const node*>(),
+                                              std::equal_to<const node*>(),
+                                              get_allocator());
+        typename key_pool_type::copy_memo key_memo = key_pool.make_memo();
+        typename value_pool_type::copy_memo value_memo =
+            value_pool.make_memo();
+        try {
+            twins.emplace(nullptr, nullptr);
+            for (node* n = queue.sorted_by_value.first; n != nullptr;
+                 n = value_index::next(n)) {
+                node*& twin = twins[n];
+                key_handle k = key_pool.copy(n->key, key_memo);
+                value_handle v;
+                try {
+                    v = value_pool.copy(n->value, value_memo);
+                } catch (...) {
+                    key_pool.release(k);
+                    throw;
+                }
+                twin = create_node_from_handles(k, v);
+                twin->priority = n->priority;
+                twin->count = n->count;
+                weight_policy::copy(twin, n);
+            }
+        } catch (...) {
+            for (auto& t : twins)
+                if (t.second != nullptr) destroy_node(t.second);
+            throw;
+        }
+
+        for (auto& t : twins) {
+            if (t.first == nullptr) continue;
+            t.second->by_value.parent = twins[t.first->by_value.parent];
+            t.second->by_value.left = twins[t.first->by_value.left];
+            t.second->by_value.right = twins[t.first->by_value.right];
+            t.second->by_key.parent = twins[t.first->by_key.parent];
+            t.second->by_key.left = twins[t.first->by_key.left];
+            t.second->by_key.right = twins[t.first->by_key.right];
+        }
+        sorted_by_value.root = twins[queue.sorted_by_value.root];
+        sorted_by_value.first = twins[queue.sorted_by_value.first];
+        sorted_by_value.last = twins[queue.sorted_by_value.last];
+        sorted_by_key.root = twins[queue.sorted_by_key.root];
+        sorted_by_key.first = twins[queue.sorted_by_key.first];
+        sorted_by_key.last = twins[queue.sorted_by_key.last];
+    }
+
+    // Konstruktor tworzący kolejkę z par (klucz, wartość) z zakresu
+    // [first, last) - elementy zakresu muszą mieć pola first i second
+    // [O(n log n)]. Zamiast n wstawień sortujemy węzły raz po wartości i raz
+    // po kluczu, a oba drzewa budujemy liniowo.
+    template <typename InputIt>
+    PriorityQueue(InputIt first, InputIt last, const Alloc& alloc = Alloc())
+        : PriorityQueue(alloc) {
+        PRIORITY_QUEUE_SCOPE(*this, build);
+        build_range(first, last);
+    }
+
+    template <typename InputIt>
+    PriorityQueue(InputIt first, InputIt last, const CompareK& key_less,
+                  const CompareV& value_less, const Alloc& alloc = Alloc())
+        : PriorityQueue(key_less, value_less, alloc) {
+        PRIORITY_QUEUE_SCOPE(*this, build);
+        build_range(first, last);
+    }
+
+    // Konstruktor przenoszący [O(1)]; queue zostaje pusta, z tym samym
+    // alokatorem i komparatorami
+    PriorityQueue(PriorityQueue&& queue) noexcept(nothrow_compare_copy())
+        : PriorityQueue(queue.key_comp_ref(), queue.value_comp_ref(),
+                        queue.get_allocator()) {
+        this->swap(queue);
+    }
+
+    // Przeniesienie do pamięci z alokatora alloc [O(1), a przy różnych
+    // alokatorach O(queue.size()) na kopię]
+    PriorityQueue(PriorityQueue&& queue, const Alloc& alloc)
+        : PriorityQueue(queue.key_comp_ref(), queue.value_comp_ref(), alloc) {
+        if (get_allocator() == queue.get_allocator()) {
+            this->swap(queue);
+        } else {
+            PriorityQueue tmp(queue, alloc);
+            this->swap(tmp);
+        }
+    }
+
+    // Gdy K i V mają trywialne destruktory, węzłów i kopii nie trzeba
+    // obchodzić - pule od razu zwalniają swoje kawałki pamięci [O(liczba
+    // kawałków)]; w pozostałych przypadkach [O(size())]
+    ~PriorityQueue() {
+        if (!std::is_trivially_destructible<K>::value ||
+            !std::is_trivially_destructible<V>::value)
+            destroy_all();
+    }
 
     // Operator przypisania [O(queue.size()) dla użycia P = Q, a O(1) dla użycia
-    // P = move(Q)]
-    PriorityQueue<K, V>& operator=(const PriorityQueue<K, V>& queue) {
+    // P = move(Q)]; alokator przechodzi z queue zgodnie z
+    // propagate_on_container_copy_assignment / move_assignment. Jeśli
+    // alokator nie przechodzi i jest różny od alokatora queue, przeniesienie
+    // kopiuje węzły (i może rzucić).
+    PriorityQueue& operator=(const PriorityQueue& queue) {
         if (this == &queue) return *this;
-        PriorityQueue<K, V> tmp(queue);
+        PRIORITY_QUEUE_SCOPE(*this, copy);
+        PriorityQueue tmp(
+            queue,
+            alloc_traits::propagate_on_container_copy_assignment::value
+                ? queue.get_allocator()
+                : get_allocator());
         this->swap(tmp);
         return *this;
     }
 
-    PriorityQueue<K, V>& operator=(PriorityQueue<K, V>&& queue) noexcept(true) {
-        this->sorted_by_value = std::move(queue.sorted_by_value);
-        this->sorted_by_key = std::move(queue.sorted_by_key);
-        this->all_values = std::move(queue.all_values);
+    PriorityQueue& operator=(PriorityQueue&& queue) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value &&
+        nothrow_compare_copy()) {
+        if (this == &queue) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value) {
+            PriorityQueue tmp(std::move(queue));
+            this->swap(tmp);
+        } else {
+            PriorityQueue tmp(std::move(queue), get_allocator());
+            this->swap(tmp);
+        }
         return *this;
     }
 
+    // Zastępuje zawartość kolejki parami z zakresu [first, last)
+    // [O(size() + n log n)]; silna gwarancja
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        PRIORITY_QUEUE_SCOPE(*this, build);
+        PriorityQueue tmp(first, last, key_comp_ref(), value_comp_ref(),
+                          get_allocator());
+        tmp.set_capacity(limit);
+        this->swap(tmp);
+    }
+
+    // Kopia alokatora kolejki [O(1)]
+    Alloc get_allocator() const noexcept { return slab.get_allocator(); }
+
+    // Kopie komparatorów kluczy i wartości [O(1)]
+    CompareK key_comp() const { return key_comp_ref(); }
+    CompareV value_comp() const { return value_comp_ref(); }
+
     // Metoda zwracająca true wtedy i tylko wtedy, gdy kolejka jest pusta [O(1)]
-    bool empty() const noexcept { return sorted_by_value.empty(); }
+    bool empty() const noexcept { return total == 0; }
 
     // Metoda zwracająca liczbę par (klucz, wartość) przechowywanych w kolejce
     // [O(1)]
-    size_type size() const noexcept { return sorted_by_value.size(); }
+    size_type size() const noexcept { return total; }
 
     // Metoda wstawiająca do kolejki parę o kluczu key i wartości value
     // [O(log size())] (dopuszczamy możliwość występowania w kolejce wielu
     // par o tym samym kluczu)
     void insert(const K& key, const V& value) {
-        using std::make_pair;
-        using std::tie;
-
-        key_ptr k;
-        value_ptr v;
-        tie(k, v) = find_element(key, value);
-
-        auto pair_by_value = make_pair(k, v);
-
-        // Iteratory
-        typename elements::iterator it1;
-        typename key_map::iterator it2;
-        typename value_map::iterator it3;
-        typename element_set<>::iterator it4;
-        typename value_set::iterator it5;
-
-        bool al1 = false, al2 = false, al3 = false, al4 = false, al5 = false;
-
-        // Polegamy na silnej gwarancji kontenerów STL (map, set)
-        try {
-            it1 = sorted_by_value.insert(pair_by_value);
-            al1 = true;
-
-            tie(it2, al2) = sorted_by_key.insert(make_pair(k, value_map()));
-
-            tie(it3, al3) = it2->second.insert(make_pair(v, element_set<>()));
-
-            it4 = it3->second.insert(pair_by_value);
-            al4 = true;
+        PRIORITY_QUEUE_SCOPE(*this, insert);
+        if (total < limit)
+            insert_element(key, value, 1);
+        else
+            insert_bounded(key, value);
+    }
 
-            it5 = all_values.insert(v);
-            al5 = true;
-        } catch (...) {
-            if (al5) all_values.erase(it5);
-            if (al4) it3->second.erase(it4);
-            if (al3) it2->second.erase(it3);
-            if (al2) sorted_by_key.erase(it2);
-            if (al1) sorted_by_value.erase(it1);
-            throw;
-        }
+    // Ogranicza kolejkę do n par o największych wartościach (top-k)
+    // [O((size() - n) log size()) na usunięcie nadmiaru]. Gdy kolejka jest
+    // pełna, insert pary o wartości nie większej niż minValue() nic nie
+    // zmienia (kosztuje jedno porównanie), a lepsza para zajmuje węzeł
+    // wyrzuconego minimum - bez alokacji. Merge, insert_many i assign też
+    // zostawiają n największych. Ograniczenie kopiuje się i zamienia razem
+    // z kolejką; domyślnie go nie ma.
+    void set_capacity(size_type n) noexcept {
+        limit = n;
+        trim();
     }
+    size_type capacity() const noexcept { return limit; }
 
     // Metody zwracające odpowiednio najmniejszą i największą wartość
     // przechowywaną
     // w kolejce [O(1)]; w przypadku wywołania którejś z tych metod na pustej
     // strukturze powinien zostać zgłoszony wyjątek PriorityQueueEmptyException
     const V& minValue() const {
+        PRIORITY_QUEUE_SCOPE(*this, extremes);
         if (empty()) throw PriorityQueueEmptyException();
-        return *(sorted_by_value.begin()->second);
+        return value_of(*sorted_by_value.first);
     }
     const V& maxValue() const {
+        PRIORITY_QUEUE_SCOPE(*this, extremes);
         if (empty()) throw PriorityQueueEmptyException();
-        return *(sorted_by_value.rbegin()->second);
+        return value_of(*sorted_by_value.last);
     }
 
     // Metody zwracające klucz o przypisanej odpowiednio najmniejszej lub
@@ -197,58 +2204,49 @@ class PriorityQueue {
     // na pustej strukturze powinien zostać zgłoszony wyjątek
     // PriorityQueueEmptyException
     const K& minKey() const {
+        PRIORITY_QUEUE_SCOPE(*this, extremes);
         if (empty()) throw PriorityQueueEmptyException();
-        return *(sorted_by_value.begin()->first);
+        return key_of(*sorted_by_value.first);
     }
     const K& maxKey() const {
+        PRIORITY_QUEUE_SCOPE(*this, extremes);
         if (empty()) throw PriorityQueueEmptyException();
-        return *(sorted_by_value.rbegin()->first);
+        return key_of(*sorted_by_value.last);
     }
 
     // Metody usuwające z kolejki jedną parę o odpowiednio najmniejszej lub
     // największej wartości [O(log size())]
+    // Węzeł jest podpięty do obu drzew, więc nie trzeba go szukać ani
+    // porównywać - gwarancja no-throw
     void deleteMin() {
+        PRIORITY_QUEUE_SCOPE(*this, deleteMin);
         if (empty()) return;
-        const element& e = *(sorted_by_value.begin());
-        value_ptr v = e.second;
-
-        auto kit = sorted_by_key.find(e.first);
-        assert(kit != sorted_by_key.end());
-        auto vit = kit->second.find(e.second);
-        assert(vit != kit->second.end());
-        auto ait = vit->second.begin();
-        assert(ait != vit->second.end());
-        auto bit = all_values.find(e.second);
-        assert(bit != all_values.end());
-
-        // Modyfikacje
-        vit->second.erase(ait);
-        if (vit->second.empty()) kit->second.erase(vit);
-        if (kit->second.empty()) sorted_by_key.erase(kit);
-        sorted_by_value.erase(sorted_by_value.begin());
-        all_values.erase(bit);
+        remove_one(sorted_by_value.first);
     }
 
     void deleteMax() {
+        PRIORITY_QUEUE_SCOPE(*this, deleteMax);
         if (empty()) return;
-        const element& e = *prev(sorted_by_value.end());
-        value_ptr v = e.second;
-
-        auto kit = sorted_by_key.find(e.first);
-        assert(kit != sorted_by_key.end());
-        auto vit = kit->second.find(e.second);
-        assert(vit != kit->second.end());
-        auto ait = vit->second.begin();
-        assert(ait != vit->second.end());
-        auto bit = all_values.find(e.second);
-        assert(bit != all_values.end());
-
-        // Modyfikacje
-        vit->second.erase(ait);
-        if (vit->second.empty()) kit->second.erase(vit);
-        if (kit->second.empty()) sorted_by_key.erase(kit);
-        sorted_by_value.erase(prev(sorted_by_value.end()));
-        all_values.erase(bit);
+        remove_one(sorted_by_value.last);
+    }
+
+    // Metody usuwające i zwracające parę (klucz, wartość) o odpowiednio
+    // najmniejszej lub największej wartości [O(log size())] - zamiast
+    // minKey(), minValue() i deleteMin(); na pustej kolejce zgłaszają
+    // PriorityQueueEmptyException. Klucz i wartość są przenoszone, gdy
+    // nie korzysta z nich żaden inny węzeł (ani powtórzenie), w przeciwnym
+    // razie kopiowane. Silna gwarancja, o ile przeniesienie K i V nie
+    // rzuca. Liczą się jako deleteMin i deleteMax.
+    std::pair<K, V> popMin() {
+        PRIORITY_QUEUE_SCOPE(*this, deleteMin);
+        if (empty()) throw PriorityQueueEmptyException();
+        return pop(sorted_by_value.first);
+    }
+
+    std::pair<K, V> popMax() {
+        PRIORITY_QUEUE_SCOPE(*this, deleteMax);
+        if (empty()) throw PriorityQueueEmptyException();
+        return pop(sorted_by_value.last);
     }
 
     // Metoda zmieniająca dotychczasową wartość przypisaną kluczowi key na nową
@@ -257,134 +2255,460 @@ class PriorityQueue {
     // PriorityQueueNotFoundException(); w przypadku kiedy w kolejce jest kilka
     // par
     // o kluczu key, zmienia wartość w dowolnie wybranej parze o podanym kluczu
+    // Węzeł pary, która jest w kolejce raz, zmieniamy na miejscu: klucz się
+    // nie zmienia, więc sorted_by_key zostaje nietknięte, a jeśli nowa para
+    // trafia tuż obok starej, nie przepinamy też węzła w sorted_by_value.
+    // Każde drzewo przechodzimy raz; nowy węzeł tworzymy tylko wtedy, gdy
+    // odrywamy jedno z powtórzeń pary. Silna gwarancja: porównania i kopia
+    // wartości są przed pierwszą zmianą drzew.
     void changeValue(const K& key, const V& value) {
-        using std::make_pair;
-        using std::tie;
+        PRIORITY_QUEUE_SCOPE(*this, changeValue);
+        node* old = find_by_key(key);
+        if (old == nullptr) throw PriorityQueueNotFoundException();
 
-        key_ptr k;
-        value_ptr v;
-        tie(k, v) = find_element(key, value);
+        element_ref e{key, value};
+        node* vparent;
+        bool vleft, beside;
+        node* existing = find_by_value(e, vparent, vleft, old, beside);
+        // ta sama para - nic się nie zmienia
+        if (existing == old) return;
 
-        auto kit = sorted_by_key.find(k);
-        if (kit == sorted_by_key.end()) throw PriorityQueueNotFoundException();
+        if (existing != nullptr) {
+            add_repeats(existing, 1);
+            ++total;
+            remove_one(old);
+        } else if (old->count == 1) {
+            value_handle v =
+                acquire_value(value, value_twin(value, vparent, vleft));
+            // od tego miejsca nic nie rzuca
+            value_pool.release(old->value);
+            old->value = v;
+            if (!beside) sorted_by_value.relink(old, vparent, vleft);
+        } else {
+            // odrywamy jedno powtórzenie pary jako nowy węzeł
+            node* kparent;
+            bool kleft;
+            find_key_position(e, kparent, kleft);
 
-        value_ptr old = kit->second.begin()->first;
-
-        auto itr_e1 = sorted_by_value.find(make_pair(k, old));
-        auto itr_e2 = all_values.find(old);
-        auto vit = kit->second.find(old);
-        assert(vit != kit->second.end());
+            node* n = create_node(key, value, old,
+                                  value_twin(value, vparent, vleft));
+            sorted_by_value.link(n, vparent, vleft);
+            sorted_by_key.link(n, kparent, kleft);
+            drop_repeat(old);
+        }
+    }
 
-        // Wstawmy najpierw nową parę...
+    // Usuwa jedną dowolnie wybraną parę o kluczu key [O(log size())]; gdy
+    // takiej pary nie ma, zgłasza PriorityQueueNotFoundException. Silna
+    // gwarancja: rzucić mogą tylko porównania przy wyszukiwaniu, a samo
+    // usunięcie jest no-throw.
+    void erase(const K& key) {
+        PRIORITY_QUEUE_SCOPE(*this, erase);
+        node* n = find_by_key(key);
+        if (n == nullptr) throw PriorityQueueNotFoundException();
+        remove_one(n);
+    }
 
-        auto pair_by_value = make_pair(k, v);
+    // Usuwa jedno powtórzenie pary (key, value) [O(log size())]; gdy takiej
+    // pary nie ma, zgłasza PriorityQueueNotFoundException. Silna gwarancja
+    // jak dla erase(key).
+    void erase(const K& key, const V& value) {
+        PRIORITY_QUEUE_SCOPE(*this, erase);
+        element_ref e{key, value};
+        node* parent;
+        bool left;
+        node* n = find_by_value(e, parent, left);
+        if (n == nullptr) throw PriorityQueueNotFoundException();
+        remove_one(n);
+    }
 
-        // Iterators
-        typename elements::iterator it1;
-        typename key_map::iterator it2;
-        typename value_map::iterator it3;
-        typename element_set<>::iterator it4;
-        typename value_set::iterator it5;
-        // If we have to remove them on fail.
-        bool al1 = false, al2 = false, al3 = false, al4 = false, al5 = false;
-        // Polegamy na silnej gwarancji kontenerów STL (map, set)
-        try {
-            it1 = sorted_by_value.insert(pair_by_value);
-            al1 = true;
+    // Usuwa wszystkie pary o kluczu key i zwraca ich liczbę (razem
+    // z powtórzeniami; 0, gdy nie ma żadnej) [O((m + 1) log size()) dla
+    // m usuniętych węzłów]. Najpierw wyznaczamy w sorted_by_key cały
+    // przedział węzłów o tym kluczu (porównania mogą rzucić - wtedy nic się
+    // nie zmienia), potem odpinamy go bez porównań (no-throw).
+    size_type erase_all(const K& key) {
+        PRIORITY_QUEUE_SCOPE(*this, erase);
+        node* n = find_by_key(key);
+        if (n == nullptr) return 0;
 
-            tie(it2, al2) = sorted_by_key.insert(make_pair(k, value_map()));
+        KeyComparer key_less = key_comparer();
+        node* first = n;
+        for (node* m = key_index::prev(n);
+             m != nullptr && !key_less(*m, key); m = key_index::prev(m))
+            first = m;
+        node* end = key_index::next(n);
+        while (end != nullptr && !key_less(key, *end))
+            end = key_index::next(end);
 
-            tie(it3, al3) = it2->second.insert(make_pair(v, element_set<>()));
+        size_type removed = 0;
+        while (first != end) {
+            node* next = key_index::next(first);
+            removed += first->count;
+            sorted_by_value.unlink(first);
+            sorted_by_key.unlink(first);
+            destroy_node(first);
+            first = next;
+        }
+        total -= removed;
+        return removed;
+    }
 
-            it4 = it3->second.insert(pair_by_value);
-            al4 = true;
+    // Wstawia wszystkie pary z zakresu [first, last) (elementy z polami
+    // first i second) [O(n log n) plus koszt merge]; pary budujemy jako
+    // osobną kolejkę (w pamięci *this) i scalamy z *this, więc albo
+    // wstawiamy całą partię, albo nic (silna gwarancja)
+    template <typename InputIt>
+    void insert_many(InputIt first, InputIt last) {
+        PRIORITY_QUEUE_SCOPE(*this, insert_many);
+        PriorityQueue batch(key_comp_ref(), value_comp_ref(), get_allocator());
+        lend_slab(batch);
+        try {
+            batch.build_range(first, last);
+            merge(batch);
+            keep_slab(batch);
+        } catch (...) {
+            return_slab(batch);
+            throw;
+        }
+    }
 
-            it5 = all_values.insert(v);
-            al5 = true;
+    // Wykonuje changeValue(first->first, first->second) dla kolejnych
+    // elementów zakresu [first, last) [O(n log (n + size())) plus koszt
+    // merge]. Nowe pary zbieramy w osobnej kolejce, a pary do usunięcia
+    // tylko zaznaczamy; na koniec scalamy kolejki i usuwamy zaznaczone pary
+    // (no-throw). Jeśli któregoś klucza nie ma, zgłaszamy
+    // PriorityQueueNotFoundException i nic się nie zmienia (silna gwarancja
+    // dla całej partii).
+    template <typename InputIt>
+    void changeValues(InputIt first, InputIt last) {
+        PRIORITY_QUEUE_SCOPE(*this, changeValues);
+        PriorityQueue batch(key_comp_ref(), value_comp_ref(), get_allocator());
+        scratch_map<node*, size_type> taken(0, std::hash<node*>(),
+                                            std::equal_to<node*>(),
+                                            get_allocator());
+        lend_slab(batch);
+        try {
+            for (; first != last; ++first) {
+                node* old = find_spare_by_key(first->first, taken);
+                if (old != nullptr) {
+                    ++taken[old];
+                    batch.insert(first->first, first->second);
+                } else {
+                    // wszystkie pary o tym kluczu już zmieniliśmy w tej
+                    // partii (albo żadnej nie było) - zmieniamy jedną z nowych
+                    batch.changeValue(first->first, first->second);
+                }
+            }
+            merge_all(batch);
+            keep_slab(batch);
         } catch (...) {
-            if (al5) all_values.erase(it5);
-            if (al4) it3->second.erase(it4);
-            if (al3) it2->second.erase(it3);
-            if (al2) sorted_by_key.erase(it2);
-            if (al1) sorted_by_value.erase(it1);
+            return_slab(batch);
             throw;
         }
-        // A teraz usuńmy starą
-        sorted_by_value.erase(itr_e1);
-        all_values.erase(itr_e2);
-        vit->second.erase(vit->second.begin());
-        if (vit->second.size() == 0) kit->second.erase(vit);
+        for (const std::pair<node* const, size_type>& t : taken)
+            for (size_type i = 0; i < t.second; ++i) remove_one(t.first);
     }
 
     // Metoda scalająca zawartość kolejki z podaną kolejką queue; ta operacja
     // usuwa
     // wszystkie elementy z kolejki queue i wstawia je do kolejki *this
-    // [O(size() + queue.size() * log (queue.size() + size()))]
-    void merge(PriorityQueue<K, V>& queue) {
-        using std::tie;
+    // [O(size() + queue.size()) albo O(queue.size() * log (queue.size() +
+    // size())), zależnie od tego, co jest tańsze]
+    // Węzły queue nie są kopiowane, tylko przepinane do *this (razem z pamięcią
+    // puli). Najpierw wyznaczamy miejsce każdego węzła (porównania mogą
+    // rzucić - wtedy nic się nie zmienia), potem przepinamy (no-throw).
+    // Pamięci z innego alokatora nie da się przejąć - wtedy scalamy kopię
+    // queue [dodatkowo O(queue.size())], a pary queue z innymi komparatorami
+    // (patrz same_order) wstawiamy według porządku *this [dodatkowo
+    // O(queue.size() log queue.size())].
+    // Przy set_capacity scalona kolejka zostawia tylko największe pary.
+    void merge(PriorityQueue& queue) {
+        PRIORITY_QUEUE_SCOPE(*this, merge);
+        merge_all(queue);
+        trim();
+    }
 
-        if (this == &queue) return;
+    // Metody usuwające wszystkie pary i zapisujące je do out w kolejności
+    // rosnących wartości (równe wartości - w kolejności kluczy), tak jak
+    // kolejne popMin(); pary z powtórzeniami są zapisywane wielokrotnie
+    // [O(size()) oczekiwane plus koszt zapisu]. Zwraca out za ostatnią
+    // zapisaną parą. Jeśli zapis rzuci, pary zapisane wcześniej są już
+    // usunięte z kolejki, a zapisywana przepada (podstawowa gwarancja).
+    template <typename OutputIt>
+    OutputIt drain_sorted(OutputIt out) {
+        PRIORITY_QUEUE_SCOPE(*this, deleteMin);
+        while (!empty()) {
+            *out = pop(sorted_by_value.first);
+            ++out;
+        }
+        return out;
+    }
 
-        PriorityQueue<K, V> merged_queue = *this;
+    // Iterator stały po parach kolejki w porządku drzewa Index: pary
+    // z powtórzeniami pojawiają się tyle razy, ile jest ich w kolejce.
+    // Dereferencja daje parę referencji do klucza i wartości (jak
+    // std::pair<const K&, const V&>), więc iterator jest dwukierunkowy
+    // tylko w sensie przechodzenia - nie ma prawdziwego value_type&.
+    // Każda zmiana kolejki unieważnia wszystkie iteratory.
+    template <typename Index>
+    class basic_iterator {
+       public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = std::pair<K, V>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::pair<const K&, const V&>;
+
+        // Wskaźnik zastępczy - trzyma parę referencji dla operator->
+        class pointer {
+           public:
+            const reference* operator->() const noexcept { return &ref; }
 
-        for (element e : queue.sorted_by_value) {
-            key_ptr k;
-            value_ptr v;
-            tie(k, v) = merged_queue.find_element(e.first, e.second);
+           private:
+            friend class basic_iterator;
+            explicit pointer(const reference& ref) noexcept : ref(ref) {}
+            reference ref;
+        };
 
-            merged_queue.sorted_by_value.insert(e);
-            merged_queue.sorted_by_key[k][v].insert(e);
-            merged_queue.all_values.insert(v);
+        basic_iterator() noexcept = default;
+
+        reference operator*() const noexcept {
+            return reference(key_of(*n), value_of(*n));
         }
-        queue.sorted_by_value.clear();
-        queue.sorted_by_key.clear();
-        queue.all_values.clear();
+        pointer operator->() const noexcept { return pointer(**this); }
+
+        basic_iterator& operator++() noexcept {
+            if (++repeat == n->count) {
+                n = Index::next(n);
+                repeat = 0;
+            }
+            return *this;
+        }
+        basic_iterator operator++(int) noexcept {
+            basic_iterator old = *this;
+            ++*this;
+            return old;
+        }
+        basic_iterator& operator--() noexcept {
+            if (n == nullptr) {
+                n = tree->last;
+                repeat = n->count - 1;
+            } else if (repeat > 0) {
+                --repeat;
+            } else {
+                n = Index::prev(n);
+                repeat = n->count - 1;
+            }
+            return *this;
+        }
+        basic_iterator operator--(int) noexcept {
+            basic_iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        friend bool operator==(const basic_iterator& lhs,
+                               const basic_iterator& rhs) noexcept {
+            return lhs.n == rhs.n && lhs.repeat == rhs.repeat;
+        }
+        friend bool operator!=(const basic_iterator& lhs,
+                               const basic_iterator& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+       private:
+        friend class PriorityQueue;
+        basic_iterator(const Index* tree, node* n, size_type repeat) noexcept
+            : tree(tree), n(n), repeat(repeat) {}
+
+        const Index* tree = nullptr;
+        // nullptr - za ostatnią parą
+        node* n = nullptr;
+        // które powtórzenie pary z węzła n
+        size_type repeat = 0;
+    };
 
-        this->swap(merged_queue);
+    // Iteratory w kolejności rosnących wartości (równe wartości - w
+    // kolejności kluczy), czyli kolejnych popMin(), oraz w kolejności
+    // rosnących kluczy (równe klucze - w kolejności wstawienia) [O(1);
+    // przejście całej kolejki O(size())]
+    using const_iterator = basic_iterator<value_index>;
+    using iterator = const_iterator;
+    using const_key_iterator = basic_iterator<key_index>;
+
+    const_iterator begin() const noexcept {
+        return const_iterator(&sorted_by_value, sorted_by_value.first, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(&sorted_by_value, nullptr, 0);
     }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    const_key_iterator key_begin() const noexcept {
+        return const_key_iterator(&sorted_by_key, sorted_by_key.first, 0);
+    }
+    const_key_iterator key_end() const noexcept {
+        return const_key_iterator(&sorted_by_key, nullptr, 0);
+    }
+
+    // Statystyki pozycyjne po wartości - tylko z RankedTreeBackend
+    // [O(log size())]: każdy węzeł sorted_by_value zna liczbę par (razem
+    // z powtórzeniami) w swoim poddrzewie, więc pozycję wyznacza jedno
+    // zejście od korzenia. Pozycje liczymy od 0 w kolejności begin().
+
+    // Iterator na parę o pozycji i (end(), gdy i >= size())
+    const_iterator nth_by_value(size_type i) const noexcept {
+        static_assert(ranked, "nth_by_value needs RankedTreeBackend");
+        PRIORITY_QUEUE_SCOPE(*this, order);
+        node* n = sorted_by_value.root;
+        while (n != nullptr) {
+            PRIORITY_QUEUE_COUNT(nodes, 1);
+            size_type before = subtree_weight::of(n->by_value.left);
+            if (i < before) {
+                n = n->by_value.left;
+            } else if (i - before < n->count) {
+                return const_iterator(&sorted_by_value, n, i - before);
+            } else {
+                i -= before + n->count;
+                n = n->by_value.right;
+            }
+        }
+        return end();
+    }
+
+    // Liczba par o wartości mniejszej niż value - pozycja pierwszej pary
+    // o wartości value, jeśli taka jest
+    size_type rank(const V& value) const {
+        static_assert(ranked, "rank needs RankedTreeBackend");
+        PRIORITY_QUEUE_SCOPE(*this, order);
+        return count_below(value, false);
+    }
+
+    // Liczba par o wartości z przedziału domkniętego [vlo, vhi] (0, gdy
+    // vhi < vlo)
+    size_type count_in_range(const V& vlo, const V& vhi) const {
+        static_assert(ranked, "count_in_range needs RankedTreeBackend");
+        PRIORITY_QUEUE_SCOPE(*this, order);
+        if (value_key_comparer().values(vhi, vlo)) return 0;
+        return count_below(vhi, true) - count_below(vlo, false);
+    }
+
+#ifdef PRIORITY_QUEUE_STATS
+    // Liczniki metod tej kolejki (tylko w trybie pomiarowym) [O(1)]
+    const PriorityQueueStats& stats() const noexcept { return statistics; }
+    void reset_stats() noexcept { statistics.reset(); }
+#endif
 
     // Metoda zamieniającą zawartość kolejki z podaną kolejką queue (tak jak
     // większość kontenerów w bibliotece standardowej) [O(1)]
     // Gwarancja no-throw
-    void swap(PriorityQueue<K, V>& queue) noexcept {
+    void swap(PriorityQueue& queue) noexcept {
         if (this == &queue) return;
-        this->sorted_by_value.swap(queue.sorted_by_value);
-        this->sorted_by_key.swap(queue.sorted_by_key);
-        this->all_values.swap(queue.all_values);
+        key_compare_holder::swap(queue);
+        value_compare_holder::swap(queue);
+        this->swap_contents(queue);
+        std::swap(this->limit, queue.limit);
     }
 
-    friend void swap(PriorityQueue<K, V>& lhs,
-                     PriorityQueue<K, V>& rhs) noexcept {
+    friend void swap(PriorityQueue& lhs,
+                     PriorityQueue& rhs) noexcept {
         lhs.swap(rhs);
     }
 
-    friend bool operator==(const PriorityQueue<K, V>& lhs,
-                           const PriorityQueue<K, V>& rhs) {
-        return lhs.sorted_by_value == rhs.sorted_by_value;
+    // Porównania [O(size())]; każda różna para występuje w kolejce w jednym
+    // węźle, więc kolejki są równe, gdy mają równe ciągi węzłów
+    friend bool operator==(const PriorityQueue& lhs,
+                           const PriorityQueue& rhs) {
+        using priority_queue_detail::compare_equal;
+        PRIORITY_QUEUE_SCOPE(lhs, equal);
+        if (lhs.total != rhs.total) return false;
+        node* a = lhs.sorted_by_value.first;
+        node* b = rhs.sorted_by_value.first;
+        while (a != nullptr && b != nullptr) {
+            if (a->count != b->count ||
+                !compare_equal(key_of(*a), key_of(*b)) ||
+                !compare_equal(value_of(*a), value_of(*b)))
+                return false;
+            a = value_index::next(a);
+            b = value_index::next(b);
+        }
+        return a == nullptr && b == nullptr;
     }
-    friend bool operator!=(const PriorityQueue<K, V>& lhs,
-                           const PriorityQueue<K, V>& rhs) {
-        return lhs.sorted_by_value != rhs.sorted_by_value;
+    friend bool operator!=(const PriorityQueue& lhs,
+                           const PriorityQueue& rhs) {
+        return !(lhs == rhs);
     }
-    friend bool operator<(const PriorityQueue<K, V>& lhs,
-                          const PriorityQueue<K, V>& rhs) {
-        return std::lexicographical_compare(
-            lhs.sorted_by_value.begin(), lhs.sorted_by_value.end(),
-            rhs.sorted_by_value.begin(), rhs.sorted_by_value.end(),
-            ValueKeyComparer());
+    // Porównanie leksykograficzne ciągów par (z powtórzeniami) posortowanych
+    // po wartości, a potem po kluczu
+    friend bool operator<(const PriorityQueue& lhs,
+                          const PriorityQueue& rhs) {
+        PRIORITY_QUEUE_SCOPE(lhs, less);
+        ValueKeyComparer less = lhs.value_key_comparer();
+        node* a = lhs.sorted_by_value.first;
+        node* b = rhs.sorted_by_value.first;
+        size_type a_left = a ? a->count : 0;
+        size_type b_left = b ? b->count : 0;
+        while (a != nullptr && b != nullptr) {
+            if (less(*a, *b)) return true;
+            if (less(*b, *a)) return false;
+            // równoważne pary - pomijamy wspólną liczbę powtórzeń
+            size_type common = std::min(a_left, b_left);
+            a_left -= common;
+            b_left -= common;
+            if (a_left == 0) {
+                a = value_index::next(a);
+                a_left = a ? a->count : 0;
+            }
+            if (b_left == 0) {
+                b = value_index::next(b);
+                b_left = b ? b->count : 0;
+            }
+        }
+        return a == nullptr && b != nullptr;
     }
-    friend bool operator>(const PriorityQueue<K, V>& lhs,
-                          const PriorityQueue<K, V>& rhs) {
+    friend bool operator>(const PriorityQueue& lhs,
+                          const PriorityQueue& rhs) {
         return rhs < lhs;
     }
-    friend bool operator<=(const PriorityQueue<K, V>& lhs,
-                           const PriorityQueue<K, V>& rhs) {
+    friend bool operator<=(const PriorityQueue& lhs,
+                           const PriorityQueue& rhs) {
         return !(lhs > rhs);
     }
-    friend bool operator>=(const PriorityQueue<K, V>& lhs,
-                           const PriorityQueue<K, V>& rhs) {
+    friend bool operator>=(const PriorityQueue& lhs,
+                           const PriorityQueue& rhs) {
         return !(lhs < rhs);
     }
 };
 
+// Kolejka z silnikiem Backend - HeapQueue albo PriorityQueue, zależnie od
+// silnika; dla kodu sparametryzowanego silnikiem
+template <typename K, typename V, typename Backend,
+          typename Alloc = std::allocator<std::pair<const K, V>>>
+using QueueFor =
+    typename std::conditional<is_heap_backend<Backend>::value,
+                              HeapQueue<K, V, Backend, Alloc>,
+                              PriorityQueue<K, V, Backend, Alloc>>::type;
+
+#if __cplusplus >= 201703L
+// Kolejka w pamięci z std::pmr::memory_resource (tylko od C++17). Z areną
+// std::pmr::monotonic_buffer_resource węzły i pomocnicze kontenery są
+// wycinane z areny, a zniszczenie kolejki z trywialnie niszczalnymi K i V
+// nie obchodzi węzłów - całą pamięć oddaje dopiero arena:
+//   std::pmr::monotonic_buffer_resource arena;
+//   PmrPriorityQueue<int, int> queue(&arena);
+// Kopia (konstruktor kopiujący) korzysta z domyślnego zasobu
+// (std::pmr::get_default_resource()), tak jak kontenery std::pmr.
+template <typename K, typename V, typename Backend = TreeBackend>
+using PmrPriorityQueue =
+    PriorityQueue<K, V, Backend,
+                  std::pmr::polymorphic_allocator<std::pair<const K, V>>>;
+
+// To samo dla QueueFor
+template <typename K, typename V, typename Backend = TreeBackend>
+using PmrQueueFor =
+    QueueFor<K, V, Backend,
+             std::pmr::polymorphic_allocator<std::pair<const K, V>>>;
+#endif
+
 #endif /* end of include guard: _JNP1_PRIORITYQUEUE_HH_ */
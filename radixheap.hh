@@ -0,0 +1,445 @@
+#ifndef _JNP1_RADIXHEAP_HH_
+#define _JNP1_RADIXHEAP_HH_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+namespace priority_queue_detail {
+
+// Kod wartości zachowujący porządek: a < b wtedy i tylko wtedy, gdy
+// radix_code(a) < radix_code(b) (dla liczb zmiennoprzecinkowych poza NaN;
+// -0.0 dostaje mniejszy kod niż +0.0)
+template <typename V>
+typename std::enable_if<std::is_integral<V>::value, std::uint64_t>::type
+radix_code(V value) noexcept {
+    return std::is_signed<V>::value
+               ? static_cast<std::uint64_t>(static_cast<std::int64_t>(value)) ^
+                     (std::uint64_t(1) << 63)
+               : static_cast<std::uint64_t>(value);
+}
+
+// Bity liczby ujemnej odwracamy (im większy moduł, tym mniejszy kod),
+// a nieujemnej - podnosimy ponad wszystkie ujemne
+template <typename V, typename Bits>
+std::uint64_t radix_float_code(V value) noexcept {
+    static_assert(sizeof(V) == sizeof(Bits), "unexpected float layout");
+    Bits bits;
+    std::memcpy(&bits, &value, sizeof bits);
+    const Bits sign = Bits(1) << (8 * sizeof(Bits) - 1);
+    return (bits & sign) ? Bits(~bits) : Bits(bits | sign);
+}
+
+inline std::uint64_t radix_code(float value) noexcept {
+    return radix_float_code<float, std::uint32_t>(value);
+}
+inline std::uint64_t radix_code(double value) noexcept {
+    return radix_float_code<double, std::uint64_t>(value);
+}
+
+}  // namespace priority_queue_detail
+
+// Silnik oparty na kopcu pozycyjnym (radix heap) dla przebiegów monotonicznych
+// (np. algorytm Dijkstry): wartości wstawiane i ustawiane przez changeValue
+// nie mogą być mniejsze od ostatnio odczytanego albo usuniętego minimum.
+// Węzeł trafia do kubełka o numerze najstarszego bitu, którym jego wartość
+// różni się od tego minimum, więc każdy węzeł przechodzi między kubełkami
+// najwyżej 64 razy: insert w O(1), deleteMin, minValue i minKey w O(log C)
+// zamortyzowanym (C - rozpiętość wartości w kolejce, najwyżej 64).
+// Wartości całkowite albo float i double. Naruszenie monotoniczności
+// wyłapuje assert (w kompilacji bez NDEBUG); pusta kolejka zaczyna od
+// dowolnej wartości. Tak jak w PairingHeapBackend każda para ma własny
+// węzeł (więc silnik działa z HeapQueue), indeks po kluczu (dla
+// changeValue) jest uzupełniany leniwie, a maksimum nie jest dostępne.
+struct RadixHeapBackend {};
+
+template <>
+struct is_heap_backend<RadixHeapBackend> : std::true_type {};
+
+template <typename K, typename V, typename Alloc>
+class HeapQueue<K, V, RadixHeapBackend, Alloc> {
+    static_assert(std::is_integral<V>::value ||
+                      std::is_same<V, float>::value ||
+                      std::is_same<V, double>::value,
+                  "RadixHeapBackend needs an integral, float or double value");
+
+   public:
+    using key_type = K;
+    using value_type = V;
+    using size_type = std::size_t;
+    using allocator_type = Alloc;
+
+   protected:
+    struct node {
+        // sąsiedzi na liście kubełka
+        node* prev = nullptr;
+        node* next = nullptr;
+        // indeks po kluczu; węzeł spoza indeksu (indexed == false) czeka na
+        // liście pending, powiązanej przez by_key.left i by_key.right
+        priority_queue_detail::tree_hook<node> by_key;
+        bool indexed = false;
+        unsigned char bucket = 0;
+        unsigned priority;
+        K key;
+        V value;
+
+        node(const K& key, const V& value, unsigned priority)
+            : priority(priority), key(key), value(value) {}
+    };
+
+    class ValueKeyComparer {
+       public:
+        bool operator()(const node* lhs, const node* rhs) const {
+            using priority_queue_detail::radix_code;
+            std::uint64_t l = radix_code(lhs->value);
+            std::uint64_t r = radix_code(rhs->value);
+            if (l != r) return l < r;
+            return priority_queue_detail::compare_less(lhs->key, rhs->key);
+        }
+    };
+
+    // kubełek 0 - wartości równe minimum, kubełek b > 0 - wartości różniące
+    // się od minimum najstarszym bitem b - 1
+    static constexpr unsigned bucket_count = 65;
+
+    using alloc_traits = std::allocator_traits<Alloc>;
+    template <typename T>
+    using scratch_vector = priority_queue_detail::scratch_vector<T, Alloc>;
+
+    // węzły (z pamięcią) i ich indeks po kluczu (dla changeValue)
+    priority_queue_detail::lazy_key_index<node, Alloc> nodes;
+    // Głowy list kubełków. Kubełki przelicza dopiero odczyt albo usunięcie
+    // minimum (refill), stąd mutable - gorliwe przeliczanie po deleteMin
+    // podniosłoby last ponad odległość właśnie usuniętego wierzchołka
+    // i Dijkstra nie mógłby wstawić krótszej ścieżki.
+    mutable node* buckets[bucket_count] = {};
+    // bit b - 1 - kubełek b > 0 jest niepusty
+    mutable std::uint64_t occupied = 0;
+    // kod ostatnio odczytanego albo usuniętego minimum; żadna wartość
+    // w kolejce nie jest mniejsza
+    mutable std::uint64_t last = 0;
+    size_type total = 0;
+
+   protected:
+    // Operacje na kubełkach; nie rzucają
+
+    unsigned bucket_of(const V& value) const noexcept {
+        std::uint64_t code = priority_queue_detail::radix_code(value);
+        assert(code >= last && "RadixHeapBackend: value below the minimum");
+        if (code == last) return 0;
+        return 64 - __builtin_clzll(code ^ last);
+    }
+
+    void push_bucket(node* n) const noexcept {
+        unsigned b = bucket_of(n->value);
+        n->bucket = static_cast<unsigned char>(b);
+        n->prev = nullptr;
+        n->next = buckets[b];
+        if (buckets[b] != nullptr) buckets[b]->prev = n;
+        buckets[b] = n;
+        if (b > 0) occupied |= std::uint64_t(1) << (b - 1);
+    }
+
+    void pop_bucket(node* n) const noexcept {
+        unsigned b = n->bucket;
+        if (n->prev != nullptr)
+            n->prev->next = n->next;
+        else
+            buckets[b] = n->next;
+        if (n->next != nullptr) n->next->prev = n->prev;
+        n->prev = n->next = nullptr;
+        if (b > 0 && buckets[b] == nullptr)
+            occupied &= ~(std::uint64_t(1) << (b - 1));
+    }
+
+    // Pusty kubełek 0 w niepustej kolejce: nowym minimum jest najmniejsza
+    // wartość z pierwszego niepustego kubełka, a jego węzły rozchodzą się do
+    // niższych kubełków [O(rozmiar kubełka)]. Po powrocie kubełek 0 zawiera
+    // minimum, o ile kolejka nie jest pusta.
+    void refill() const noexcept {
+        if (buckets[0] != nullptr || occupied == 0) return;
+        unsigned b = __builtin_ctzll(occupied) + 1;
+        node* list = buckets[b];
+        buckets[b] = nullptr;
+        occupied &= ~(std::uint64_t(1) << (b - 1));
+
+        std::uint64_t lowest = priority_queue_detail::radix_code(list->value);
+        for (node* n = list->next; n != nullptr; n = n->next)
+            lowest = std::min(lowest,
+                              priority_queue_detail::radix_code(n->value));
+        last = lowest;
+        while (list != nullptr) {
+            node* next = list->next;
+            push_bucket(list);
+            list = next;
+        }
+    }
+
+    // Przelicza kubełki wszystkich węzłów względem minimum code <= last
+    // [O(size())]
+    void rebase(std::uint64_t code) noexcept {
+        node* all = nullptr;
+        for (node*& head : buckets) {
+            while (head != nullptr) {
+                node* n = head;
+                head = n->next;
+                n->next = all;
+                all = n;
+            }
+        }
+        occupied = 0;
+        last = code;
+        while (all != nullptr) {
+            node* next = all->next;
+            push_bucket(all);
+            all = next;
+        }
+    }
+
+    // Wywołuje f(n) dla każdego węzła (kolejność dowolna); f może
+    // zniszczyć n albo przepiąć go do innej kolejki [O(size())]
+    template <typename F>
+    void for_each_node(F f) const {
+        for (node* head : buckets) {
+            while (head != nullptr) {
+                node* next = head->next;
+                f(head);
+                head = next;
+            }
+        }
+    }
+
+    // Kubełki wystarczy opróżnić - węzły niszczy indeks
+    void destroy_all() noexcept {
+        std::fill(buckets, buckets + bucket_count, nullptr);
+        occupied = 0;
+        nodes.destroy_all();
+        total = 0;
+    }
+
+    // Węzły posortowane po wartości, a potem po kluczu [O(size() *
+    // log size())]
+    scratch_vector<const node*> sorted_nodes() const {
+        scratch_vector<const node*> out(get_allocator());
+        out.reserve(total);
+        for_each_node([&out](node* n) { out.push_back(n); });
+        std::sort(out.begin(), out.end(), ValueKeyComparer());
+        return out;
+    }
+
+   public:
+    // Konstruktor bezparametrowy tworzący pustą kolejkę [O(1)]
+    HeapQueue() : HeapQueue(Alloc()) {}
+
+    // Pusta kolejka korzystająca z alokatora alloc [O(1)]
+    explicit HeapQueue(const Alloc& alloc) : nodes(alloc) {}
+
+    // Konstruktor kopiujący [O(queue.size())]
+    HeapQueue(const HeapQueue& queue)
+        : HeapQueue(queue,
+                    alloc_traits::select_on_container_copy_construction(
+                        queue.get_allocator())) {}
+
+    // Kopia queue w pamięci z alokatora alloc [O(queue.size())]; kopie
+    // trafiają do tych samych kubełków i na pending
+    HeapQueue(const HeapQueue& queue, const Alloc& alloc)
+        : HeapQueue(alloc) {
+        last = queue.last;
+        try {
+            queue.for_each_node([this](node* n) {
+                node* twin = nodes.create(n->key, n->value);
+                nodes.push_pending(twin);
+                push_bucket(twin);
+                ++total;
+            });
+        } catch (...) {
+            destroy_all();
+            throw;
+        }
+    }
+
+    // Konstruktor przenoszący [O(1)]
+    HeapQueue(HeapQueue&& queue) noexcept
+        : HeapQueue(queue.get_allocator()) {
+        this->swap(queue);
+    }
+
+    // [O(size()), a dla trywialnie niszczalnych K O(liczba kawałków puli)]
+    ~HeapQueue() {
+        if (!std::is_trivially_destructible<node>::value) destroy_all();
+    }
+
+    // Operator przypisania [O(queue.size()) dla użycia P = Q, a O(1) dla użycia
+    // P = move(Q)]; alokator przechodzi tak jak w silniku drzewiastym
+    HeapQueue& operator=(const HeapQueue& queue) {
+        if (this == &queue) return *this;
+        HeapQueue tmp(
+            queue, alloc_traits::propagate_on_container_copy_assignment::value
+                       ? queue.get_allocator()
+                       : get_allocator());
+        this->swap(tmp);
+        return *this;
+    }
+
+    HeapQueue& operator=(HeapQueue&& queue) noexcept(
+        alloc_traits::propagate_on_container_move_assignment::value) {
+        if (this == &queue) return *this;
+        if (alloc_traits::propagate_on_container_move_assignment::value ||
+            get_allocator() == queue.get_allocator()) {
+            HeapQueue tmp(std::move(queue));
+            this->swap(tmp);
+        } else {
+            HeapQueue tmp(queue, get_allocator());
+            this->swap(tmp);
+        }
+        return *this;
+    }
+
+    // Kopia alokatora kolejki [O(1)]
+    Alloc get_allocator() const noexcept { return nodes.get_allocator(); }
+
+    // [O(1)]
+    bool empty() const noexcept { return total == 0; }
+    size_type size() const noexcept { return total; }
+
+    // Wstawienie pary [O(1)]; value nie może być mniejsza od ostatnio
+    // odczytanego albo usuniętego minimum, chyba że kolejka jest pusta - wtedy
+    // ograniczenie spada do value (ale nie rośnie, żeby Dijkstra mógł
+    // wstawiać sąsiadów w dowolnej kolejności)
+    void insert(const K& key, const V& value) {
+        node* n = nodes.create(key, value);
+        if (total == 0)
+            last = std::min(last, priority_queue_detail::radix_code(value));
+        nodes.push_pending(n);
+        push_bucket(n);
+        ++total;
+    }
+
+    // Najmniejsza wartość i jej klucz [O(1), a po usunięciu minimum
+    // O(log C) zamortyzowane]; odczyt może przeliczyć kubełki, więc nie jest
+    // bezpieczny dla równoległych czytelników
+    const V& minValue() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        refill();
+        return buckets[0]->value;
+    }
+    const K& minKey() const {
+        if (empty()) throw PriorityQueueEmptyException();
+        refill();
+        return buckets[0]->key;
+    }
+
+    // Kopiec nie zna maksimum
+    const V& maxValue() const = delete;
+    const K& maxKey() const = delete;
+    void deleteMax() = delete;
+
+    // Usunięcie pary o najmniejszej wartości [O(log C) zamortyzowane, plus
+    // O(log size()) dla pary z indeksu], no-throw
+    void deleteMin() {
+        if (empty()) return;
+        refill();
+        node* n = buckets[0];
+        pop_bucket(n);
+        nodes.unindex(n);
+        nodes.destroy(n);
+        --total;
+    }
+
+    // Zmiana wartości w dowolnej parze o kluczu key [O(log size()) plus
+    // O(p * log size()) za p par wstawionych od poprzedniego changeValue];
+    // value nie może być mniejsza od ostatnio odczytanego albo usuniętego
+    // minimum (zwykle to zmniejszenie klucza w algorytmie Dijkstry). Klucz
+    // się nie zmienia, więc węzeł zostaje w indeksie i przechodzi tylko do
+    // innego kubełka. Silna gwarancja - porównania dzieją się przed zmianą.
+    void changeValue(const K& key, const V& value) {
+        nodes.flush();
+        node* n = nodes.find(key);
+        if (n == nullptr) throw PriorityQueueNotFoundException();
+        pop_bucket(n);
+        n->value = value;
+        push_bucket(n);
+    }
+
+    // Scalenie z queue [O(queue.size()), a gdy minimum queue jest mniejsze -
+    // O(size() + queue.size())], bez porównań kluczy i no-throw dla równych
+    // alokatorów; minimum scalonej kolejki to mniejsze z minimów. Przy
+    // różnych alokatorach scalamy kopię queue.
+    void merge(HeapQueue& queue) {
+        if (this == &queue || queue.empty()) return;
+        if (!(get_allocator() == queue.get_allocator())) {
+            HeapQueue copy(queue, get_allocator());
+            HeapQueue emptied(queue.get_allocator());
+            merge(copy);
+            queue.swap(emptied);
+            return;
+        }
+        if (empty()) {
+            this->swap(queue);
+            return;
+        }
+
+        if (queue.last < last) rebase(queue.last);
+        queue.for_each_node([this](node* n) { push_bucket(n); });
+        nodes.splice(queue.nodes);
+        total += queue.total;
+
+        std::fill(queue.buckets, queue.buckets + bucket_count, nullptr);
+        queue.occupied = 0;
+        queue.total = 0;
+    }
+
+    // [O(1)], gwarancja no-throw; alokatory jak w silniku drzewiastym
+    void swap(HeapQueue& queue) noexcept {
+        if (this == &queue) return;
+        nodes.swap(queue.nodes);
+        std::swap_ranges(buckets, buckets + bucket_count, queue.buckets);
+        std::swap(occupied, queue.occupied);
+        std::swap(last, queue.last);
+        std::swap(total, queue.total);
+    }
+
+    friend void swap(HeapQueue& lhs, HeapQueue& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+    // Porównania [O(size() * log size())] - węzły trzeba najpierw
+    // posortować
+    friend bool operator==(const HeapQueue& lhs, const HeapQueue& rhs) {
+        using priority_queue_detail::compare_equal;
+        if (lhs.total != rhs.total) return false;
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        for (size_type i = 0; i < a.size(); ++i)
+            if (a[i]->value != b[i]->value ||
+                !compare_equal(a[i]->key, b[i]->key))
+                return false;
+        return true;
+    }
+    friend bool operator!=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs == rhs);
+    }
+    friend bool operator<(const HeapQueue& lhs, const HeapQueue& rhs) {
+        scratch_vector<const node*> a = lhs.sorted_nodes(),
+                                    b = rhs.sorted_nodes();
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(),
+                                            b.end(), ValueKeyComparer());
+    }
+    friend bool operator>(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return rhs < lhs;
+    }
+    friend bool operator<=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs > rhs);
+    }
+    friend bool operator>=(const HeapQueue& lhs, const HeapQueue& rhs) {
+        return !(lhs < rhs);
+    }
+};
+
+#endif /* end of include guard: _JNP1_RADIXHEAP_HH_ */
@@ -0,0 +1,116 @@
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "priorityqueue.hh"
+
+// Liczymy wszystkie wywołania globalnego operatora new
+static long allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Napisy dłuższe niż bufor SSO - każda kopia alokuje
+std::string key(int i) { return "key number " + std::to_string(i) + " (long)"; }
+std::string value(int i) { return "value number " + std::to_string(i) + " (long)"; }
+
+int main() {
+    PriorityQueue<std::string, std::string> P;
+    for (int i = 0; i < 8; ++i) P.insert(key(i), value(i));
+
+    const std::string k = key(3), v = value(3);
+    const std::string missing = key(100), other = value(5);
+
+    // Wstawienie pary, która już jest w kolejce, niczego nie kopiuje
+    long before = allocations;
+    P.insert(k, v);
+    assert(allocations == before);
+    assert(P.size() == 9);
+
+    // changeValue dla nieistniejącego klucza nie alokuje przed zgłoszeniem
+    // wyjątku (sam wyjątek alokuje przez __cxa_allocate_exception)
+    before = allocations;
+    try {
+        P.changeValue(missing, other);
+        assert(!"did not throw");
+    } catch (PriorityQueueNotFoundException&) {
+    }
+    assert(allocations == before);
+    assert(P.size() == 9);
+
+    // changeValue na parę już obecną w kolejce też nie kopiuje
+    P.insert(k, other);
+    before = allocations;
+    P.changeValue(k, other);
+    assert(allocations == before);
+    assert(P.size() == 10);
+
+    // Nowa para kopiuje dokładnie klucz i wartość (węzeł jest w puli)
+    const std::string new_key = key(42), new_value = value(42);
+    before = allocations;
+    P.insert(new_key, new_value);
+    assert(allocations == before + 2);
+
+    // Klucz i wartość, które już są w kolejce (w innych parach), nie są
+    // kopiowane ponownie - nowy węzeł korzysta z ich kopii
+    const std::string key1 = key(1), value1 = value(1);
+    before = allocations;
+    P.insert(new_key, value1);
+    P.insert(key1, new_value);
+    assert(allocations == before);
+    assert(P.size() == 13);
+
+    // Tak samo changeValue: klucz bierzemy ze starej pary, a wartość od
+    // sąsiada w kolejności wartości
+    const std::string key2 = key(2), value7 = value(7);
+    before = allocations;
+    P.changeValue(key2, value7);
+    assert(allocations == before);
+
+    // Nowa wartość dla istniejącego klucza kopiuje tylko wartość
+    const std::string key4 = key(4), value43 = value(43);
+    before = allocations;
+    P.insert(key4, value43);
+    assert(allocations == before + 1);
+    assert(P.size() == 14);
+
+    // Para bez powtórzeń, która zostaje między sąsiadami, zmienia wartość
+    // w swoim węźle - kopiujemy tylko nową wartość
+    const std::string key6 = key(6), value6 = value(6) + "!";
+    before = allocations;
+    P.changeValue(key6, value6);
+    assert(allocations == before + 1);
+    assert(P.size() == 14);
+
+    // Wszystkie kopie zostają poprawne po usunięciu par, które je utworzyły
+    PriorityQueue<std::string, std::string> C(P);
+    while (!P.empty()) {
+        assert(P.minValue() == C.minValue() && P.minKey() == C.minKey());
+        P.deleteMin();
+        C.deleteMin();
+    }
+
+    // Pełna ograniczona kolejka: gorsza para nic nie kosztuje, a lepsza
+    // zajmuje węzeł minimum - kopiujemy tylko jej klucz i wartość
+    PriorityQueue<std::string, std::string> B;
+    B.set_capacity(4);
+    for (int i = 10; i < 14; ++i) B.insert(key(i), value(i));
+    const std::string key99 = key(99), worse = value(0), better = value(99);
+    before = allocations;
+    B.insert(key99, worse);
+    assert(allocations == before && B.size() == 4);
+    B.insert(key99, better);
+    assert(allocations == before + 2 && B.size() == 4);
+    assert(B.maxKey() == key99);
+
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
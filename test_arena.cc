@@ -0,0 +1,159 @@
+// PmrPriorityQueue z areną std::pmr; kompilować z -std=c++17 (FLAGS17)
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "minmaxheap.hh"
+#include "pairingheap.hh"
+#include "priorityqueue.hh"
+
+#if __cplusplus < 201703L
+#error "test_arena.cc needs -std=c++17"
+#endif
+
+// Zasób, który liczy wywołania i przekazuje je dalej
+class counting_resource : public std::pmr::memory_resource {
+    std::pmr::memory_resource* upstream;
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        ++allocations;
+        live += bytes;
+        return upstream->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, std::size_t bytes,
+                       std::size_t alignment) override {
+        ++deallocations;
+        live -= bytes;
+        upstream->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+   public:
+    long allocations = 0;
+    long deallocations = 0;
+    long live = 0;
+
+    explicit counting_resource(
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream(upstream) {}
+};
+
+// Domyślny zasób na czas testu; nic poza kopiami nie powinno z niego brać
+counting_resource fallback;
+
+std::vector<std::pair<int, int>> pairs(int n, int shift) {
+    std::vector<std::pair<int, int>> out;
+    for (int i = 0; i < n; ++i) out.emplace_back(i, (i * 7 + shift) % n);
+    return out;
+}
+
+// Wszystko mieści się w statycznym buforze: upstream to null_memory_resource,
+// więc każda alokacja spoza areny zgłosiłaby std::bad_alloc
+template <typename Backend>
+void testInBuffer() {
+    static char buffer[1 << 20];
+    std::pmr::monotonic_buffer_resource arena(
+        buffer, sizeof buffer, std::pmr::null_memory_resource());
+    long before = fallback.allocations;
+
+    PmrQueueFor<int, int, Backend> P(&arena), Q(&arena);
+    for (int i = 0; i < 1000; ++i) P.insert(i, (i * 37) % 1000);
+    for (int i = 0; i < 100; ++i) P.changeValue(i, -i);
+    Q.insert(5000, 5000);
+    P.merge(Q);
+    assert(Q.empty() && P.size() == 1001);
+
+    // top-k
+    int last = P.minValue();
+    for (int i = 0; i < 10; ++i) {
+        assert(P.minValue() >= last);
+        last = P.minValue();
+        P.deleteMin();
+    }
+    assert(P.size() == 991);
+    assert(P.get_allocator().resource() == &arena);
+    assert(fallback.allocations == before);
+}
+
+// Partie insert_many i changeValues też biorą pamięć z areny
+void testBatches() {
+    std::pmr::monotonic_buffer_resource arena(std::pmr::new_delete_resource());
+    long before = fallback.allocations;
+    PmrPriorityQueue<int, int> P(&arena);
+    std::vector<std::pair<int, int>> batch = pairs(500, 3);
+    P.insert_many(batch.begin(), batch.end());
+    P.insert_many(batch.begin(), batch.end());
+    P.changeValues(batch.begin(), batch.begin() + 100);
+    PmrPriorityQueue<int, int> R(batch.begin(), batch.end(), &arena);
+    P.merge(R);
+    assert(P.size() == 1500 && R.empty());
+    assert(fallback.allocations == before);
+}
+
+// Zniszczenie kolejki nie oddaje pamięci arenie po kawałku - całość wraca do
+// upstream dopiero przy release
+void testRelease() {
+    counting_resource upstream;
+    {
+        std::pmr::monotonic_buffer_resource arena(&upstream);
+        {
+            PmrPriorityQueue<int, int> P(&arena);
+            for (int i = 0; i < 100000; ++i) P.insert(i, i % 977);
+            for (int i = 0; i < 100; ++i) P.deleteMin();
+        }
+        assert(upstream.allocations > 0 && upstream.deallocations == 0);
+        arena.release();
+        assert(upstream.live == 0);
+    }
+    assert(upstream.live == 0);
+}
+
+// Kopia bierze pamięć z domyślnego zasobu; scalanie kolejek z różnymi
+// zasobami kopiuje węzły
+void testResources() {
+    std::pmr::monotonic_buffer_resource arena(std::pmr::new_delete_resource());
+    PmrPriorityQueue<std::string, std::string> P(&arena);
+    for (int i = 0; i < 100; ++i)
+        P.insert("key " + std::to_string(i), "value " + std::to_string(i));
+
+    long before = fallback.allocations;
+    PmrPriorityQueue<std::string, std::string> C(P);
+    assert(C == P);
+    assert(C.get_allocator().resource() == &fallback);
+    assert(fallback.allocations > before);
+
+    PmrPriorityQueue<std::string, std::string> D(P, &arena);
+    assert(D == P && D.get_allocator().resource() == &arena);
+
+    C.merge(P);
+    assert(P.empty() && C.size() == 200);
+    assert(C.get_allocator().resource() == &fallback);
+    assert(P.get_allocator().resource() == &arena);
+
+    // przypisanie nie zmienia zasobu
+    P = C;
+    assert(P == C && P.get_allocator().resource() == &arena);
+    P = std::move(D);
+    assert(P.size() == 100 && P.get_allocator().resource() == &arena);
+}
+
+int main() {
+    std::pmr::set_default_resource(&fallback);
+    testInBuffer<TreeBackend>();
+    testInBuffer<PairingHeapBackend>();
+    testInBuffer<MinMaxHeapBackend>();
+    testBatches();
+    testRelease();
+    testResources();
+    std::pmr::set_default_resource(nullptr);
+    assert(fallback.live == 0);
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
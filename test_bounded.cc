@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+#include "test_common.hh"
+
+using PQ = PriorityQueue<int, int>;
+using Pairs = std::vector<std::pair<int, int>>;
+
+void testBasic() {
+    PQ P;
+    assert(P.capacity() == std::numeric_limits<PQ::size_type>::max());
+    P.set_capacity(3);
+    assert(P.capacity() == 3);
+
+    P.insert(1, 10);
+    P.insert(2, 20);
+    P.insert(3, 30);
+    // nie większa niż minimum - odrzucona
+    P.insert(4, 5);
+    P.insert(5, 10);
+    assert(P.size() == 3 && P.minKey() == 1);
+    // lepsza wypiera minimum
+    P.insert(6, 25);
+    assert(P.size() == 3 && P.minKey() == 2 && P.maxKey() == 3);
+    // para, która już jest, dostaje powtórzenie
+    P.insert(6, 25);
+    assert(P.size() == 3 && P.minKey() == 6 && P.minValue() == 25);
+    // minimum z powtórzeniem traci jedno z nich
+    P.insert(7, 40);
+    assert(P.size() == 3 && P.minKey() == 6 && P.maxKey() == 7);
+
+    Pairs out;
+    auto end = P.drain_sorted(std::back_inserter(out));
+    (void)end;
+    assert(P.empty() && P.capacity() == 3);
+    assert((out == Pairs{{6, 25}, {3, 30}, {7, 40}}));
+
+    // zmniejszenie ograniczenia od razu usuwa najmniejsze pary
+    for (int i = 0; i < 10; ++i) P.insert(i, i);
+    assert(P.size() == 3 && P.minValue() == 7);
+    P.set_capacity(1);
+    assert(P.size() == 1 && P.minValue() == 9);
+    P.set_capacity(0);
+    assert(P.empty());
+    P.insert(1, 100);
+    assert(P.empty());
+}
+
+void testDrain() {
+    PQ P;
+    Pairs pairs = {{3, 5}, {1, 5}, {2, 1}, {2, 1}, {7, 9}};
+    for (const auto& p : pairs) P.insert(p.first, p.second);
+    std::vector<std::pair<int, int>> out(6, std::make_pair(0, 0));
+    auto end = P.drain_sorted(out.begin());
+    assert(end == out.begin() + 5 && P.empty());
+    assert((out == Pairs{{2, 1}, {2, 1}, {1, 5}, {3, 5}, {7, 9}, {0, 0}}));
+    assert(P.drain_sorted(out.begin()) == out.begin());
+}
+
+// Ograniczenie przechodzi przez kopie, swap, merge, insert_many i assign
+void testOperations() {
+    PQ P;
+    P.set_capacity(4);
+    Pairs pairs;
+    for (int i = 0; i < 10; ++i) pairs.emplace_back(i, i * 10);
+    P.insert_many(pairs.begin(), pairs.end());
+    assert(P.size() == 4 && P.minValue() == 60);
+
+    PQ copy(P);
+    assert(copy.capacity() == 4);
+    PQ assigned;
+    assigned = P;
+    assert(assigned.capacity() == 4 && assigned == P);
+
+    PQ other;
+    for (int i = 0; i < 6; ++i) other.insert(100 + i, 55 + i * 10);
+    P.merge(other);
+    assert(other.empty() && P.size() == 4);
+    assert(P.minValue() == 85 && P.maxValue() == 105);
+
+    // scalenie do pustej ograniczonej kolejki też ucina nadmiar
+    PQ empty;
+    empty.set_capacity(2);
+    PQ full(pairs.begin(), pairs.end());
+    empty.merge(full);
+    assert(empty.capacity() == 2 && empty.size() == 2);
+    assert(full.capacity() == std::numeric_limits<PQ::size_type>::max());
+    assert(empty.minValue() == 80);
+
+    swap(empty, full);
+    assert(full.capacity() == 2 && full.size() == 2);
+    assert(empty.capacity() == std::numeric_limits<PQ::size_type>::max());
+
+    full.assign(pairs.begin(), pairs.end());
+    assert(full.capacity() == 2 && full.size() == 2);
+    assert(full.minValue() == 80);
+
+    // changeValue nie zmienia rozmiaru
+    full.changeValue(8, 1);
+    assert(full.size() == 2 && full.minKey() == 8);
+    Pairs changes = {{8, 1000}, {9, 2}};
+    full.changeValues(changes.begin(), changes.end());
+    assert(full.size() == 2 && full.minKey() == 9 && full.maxKey() == 8);
+
+    PQ moved(std::move(full));
+    assert(moved.capacity() == 2 && moved.size() == 2);
+}
+
+// Rzucające porównanie przy odrzucaniu minimum nie psuje kolejki
+void testStrongGuarantee() {
+    PriorityQueue<int, Fragile> P;
+    P.set_capacity(5);
+    for (int i = 0; i < 5; ++i) P.insert(i, Fragile{i});
+    auto backup = P;
+
+    throw_now = true;
+    expect_throw([&] { P.insert(10, Fragile{10}); });
+    throw_now = false;
+    assert(P == backup);
+}
+
+// Top-k strumienia zgadza się z sortowaniem całego strumienia
+template <typename V, typename MakeValue>
+void testRandom(MakeValue make_value) {
+    std::mt19937 twister(42);
+    for (std::size_t k : {1, 5, 50, 500}) {
+        PriorityQueue<int, V> P;
+        P.set_capacity(k);
+        std::vector<std::pair<V, int>> stream;
+        for (int i = 0; i < 5000; ++i) {
+            int key = twister() % 100;
+            V value = make_value(twister() % 1000);
+            P.insert(key, value);
+            stream.emplace_back(value, key);
+            assert(P.size() == std::min<std::size_t>(k, stream.size()));
+        }
+        std::sort(stream.begin(), stream.end());
+        std::vector<std::pair<int, V>> out;
+        P.drain_sorted(std::back_inserter(out));
+        assert(out.size() == k);
+        // przy równych wartościach na granicy zostają dowolne klucze, więc
+        // porównujemy same wartości
+        for (std::size_t i = 0; i < k; ++i)
+            assert(out[i].second == stream[stream.size() - k + i].first);
+        for (std::size_t i = 1; i < k; ++i)
+            assert(!(out[i].second < out[i - 1].second));
+    }
+}
+
+int main() {
+    testBasic();
+    testDrain();
+    testOperations();
+    testStrongGuarantee();
+    testRandom<int>([](int v) { return v; });
+    testRandom<std::string>(
+        [](int v) { return "value " + std::to_string(1000 + v); });
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
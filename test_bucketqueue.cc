@@ -0,0 +1,188 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "bucketqueue.hh"
+#include "test_common.hh"
+
+using PQ = HeapQueue<int, unsigned short, BucketQueueBackend<4096>>;
+
+PQ f(PQ q) { return q; }
+
+void testBasic() {
+    PQ P = f(PQ());
+    assert(P.empty());
+
+    P.insert(1, 42);
+    P.insert(2, 13);
+
+    assert(P.size() == 2);
+    assert(P.minKey() == 2 && P.minValue() == 13);
+    assert(P.maxKey() == 1 && P.maxValue() == 42);
+
+    PQ Q(f(P));
+    Q.deleteMin();
+    Q.deleteMin();
+    Q.deleteMin();
+    assert(Q.empty());
+
+    PQ R(Q);
+    R.insert(1, 100);
+    R.insert(2, 100);
+    R.insert(3, 300);
+
+    PQ S;
+    S = R;
+
+    try {
+        S.changeValue(4, 400);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+
+    S.changeValue(2, 200);
+    assert(S.minKey() == 1);
+    S.changeValue(3, 50);
+    assert(S.minKey() == 3 && S.minValue() == 50);
+
+    unsigned short last = 0;
+    while (!S.empty()) {
+        assert(S.minValue() >= last);
+        last = S.minValue();
+        S.deleteMin();
+    }
+    try {
+        S.minValue();
+        assert(!"S.minValue() on empty S did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+
+    PQ T;
+    T.insert(1, 1);
+    T.insert(2, 4);
+    S.insert(3, 9);
+    S.insert(4, 16);
+    S.changeValue(4, 15);
+    S.merge(T);
+    assert(S.size() == 4);
+    assert(S.minValue() == 1 && S.maxValue() == 15);
+    assert(T.empty());
+    S.changeValue(2, 0);
+    assert(S.minKey() == 2);
+
+    S = R;
+    swap(R, T);
+    assert(T == S);
+    assert(T != R);
+    assert(R < T);
+
+    R = std::move(S);
+    assert(T != S);
+    assert(T == R);
+}
+
+// Wartości spoza [0, Levels) są odrzucane, a kolejka się nie zmienia
+void testRange() {
+    HeapQueue<int, int, BucketQueueBackend<100>> P;
+    P.insert(1, 0);
+    P.insert(2, 99);
+    for (int bad : {-1, 100, 1 << 20}) {
+        try {
+            P.insert(3, bad);
+            assert(!"did not throw");
+        } catch (const PriorityQueueValueOutOfRangeException&) {
+        }
+        try {
+            P.changeValue(1, bad);
+            assert(!"did not throw");
+        } catch (const PriorityQueueValueOutOfRangeException&) {
+        }
+    }
+    assert(P.size() == 2 && P.minValue() == 0 && P.maxValue() == 99);
+
+    // wartości z kilku słów podsumowania
+    HeapQueue<int, unsigned, BucketQueueBackend<100000>> Q;
+    Q.insert(1, 99999);
+    Q.insert(2, 5000);
+    Q.insert(3, 70000);
+    assert(Q.minValue() == 5000 && Q.maxValue() == 99999);
+    Q.deleteMax();
+    assert(Q.maxValue() == 70000 && Q.maxKey() == 3);
+    Q.deleteMin();
+    assert(Q.minValue() == 70000 && Q.size() == 1);
+}
+
+// Rzucające porównanie kluczy nie psuje kolejki
+void testStrongGuarantee() {
+    using KPQ = HeapQueue<Fragile, int, BucketQueueBackend<64>>;
+    KPQ P;
+    for (int i = 0; i < 20; ++i) P.insert(Fragile{i}, (i * 7) % 20);
+    auto backup = P;
+    P.changeValue(Fragile{0}, 0);
+    for (int i = 20; i < 40; ++i) P.insert(Fragile{i}, 20 + i % 3);
+    KPQ Q;
+    Q.insert(Fragile{100}, 5);
+    Q.insert(Fragile{101}, 50);
+
+    throw_now = true;
+    expect_throw([&] { P.changeValue(Fragile{3}, 1); });
+    // wstawianie, usuwanie skrajnych par i scalanie nie porównują kluczy
+    P.insert(Fragile{102}, 63);
+    P.deleteMax();
+    P.merge(Q);
+    P.deleteMin();
+    P.deleteMax();
+    for (int i = 0; i < 20; ++i) P.deleteMax();
+    throw_now = false;
+    assert(Q.empty());
+
+    // zostały pary 1..19 z backup i (100, 5) z Q
+    backup.insert(Fragile{100}, 5);
+    backup.deleteMin();
+    assert(P == backup && P.size() == 20);
+    assert(P.minValue() == 1 && P.maxValue() == 19);
+}
+
+// Kolejność par taka sama jak w silniku drzewiastym (także dla operator<)
+void testAgainstTree() {
+    std::mt19937 twister(7);
+    HeapQueue<std::string, int, BucketQueueBackend<256>> P, Q;
+    PriorityQueue<std::string, int> TP, TQ;
+    for (int i = 0; i < 2000; ++i) {
+        std::string key = "key " + std::to_string(twister() % 100);
+        int value = twister() % 256;
+        if (i % 2) {
+            P.insert(key, value);
+            TP.insert(key, value);
+        } else {
+            Q.insert(key, value);
+            TQ.insert(key, value);
+        }
+        if (i % 97 == 0) {
+            P.deleteMax();
+            TP.deleteMax();
+        }
+        assert((P < Q) == (TP < TQ) && (Q < P) == (TQ < TP));
+    }
+    P.merge(Q);
+    TP.merge(TQ);
+    HeapQueue<std::string, int, BucketQueueBackend<256>> C(P);
+    assert(C == P && P.size() == TP.size());
+    while (!TP.empty()) {
+        assert(P.minValue() == TP.minValue() && P.maxValue() == TP.maxValue());
+        P.deleteMin();
+        TP.deleteMin();
+    }
+    assert(P.empty() && !C.empty());
+}
+
+int main() {
+    testBasic();
+    testRange();
+    testStrongGuarantee();
+    testAgainstTree();
+    testRandomOperations<PQ, true>();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
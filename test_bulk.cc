@@ -0,0 +1,127 @@
+#include <cassert>
+#include <iostream>
+#include <list>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+#include "test_common.hh"
+
+using PQ = PriorityQueue<int, int>;
+
+void testConstruction() {
+    std::mt19937 twister(7);
+    std::vector<std::pair<int, int>> pairs;
+    PQ expected;
+    for (int i = 0; i < 5000; ++i) {
+        int key = twister() % 100, value = twister() % 100;
+        pairs.emplace_back(key, value);
+        expected.insert(key, value);
+    }
+
+    PQ P(pairs.begin(), pairs.end());
+    assert(P.size() == pairs.size());
+    assert(P == expected);
+    while (!P.empty()) {
+        assert(P.minValue() == expected.minValue());
+        assert(P.minKey() == expected.minKey());
+        assert(P.maxValue() == expected.maxValue());
+        assert(P.maxKey() == expected.maxKey());
+        P.deleteMin();
+        expected.deleteMin();
+    }
+
+    PQ E(pairs.end(), pairs.end());
+    assert(E.empty());
+
+    std::map<int, int> m{{1, 10}, {2, 5}, {3, 20}};
+    PQ M(m.begin(), m.end());
+    assert(M.size() == 3 && M.minKey() == 2 && M.maxKey() == 3);
+    M.changeValue(3, 1);
+    assert(M.minKey() == 3);
+
+    std::list<std::pair<int, int>> l{{4, 4}, {4, 4}, {4, 3}};
+    M.assign(l.begin(), l.end());
+    assert(M.size() == 3 && M.minValue() == 3 && M.maxValue() == 4);
+    M.deleteMax();
+    M.deleteMax();
+    assert(M.size() == 1 && M.minValue() == 3);
+}
+
+void testBatches() {
+    std::vector<std::pair<int, int>> pairs{{1, 10}, {2, 20}, {2, 20}, {3, 5}};
+    PQ P, expected;
+    P.insert(2, 7);
+    expected.insert(2, 7);
+    P.insert_many(pairs.begin(), pairs.end());
+    for (auto& p : pairs) expected.insert(p.first, p.second);
+    assert(P == expected);
+    assert(P.size() == 5);
+
+    // klucz 2 jest trzy razy; czwarta zmiana dotyczy jednej z nowych par
+    std::vector<std::pair<int, int>> changes{
+        {2, 1}, {2, 2}, {2, 3}, {2, 4}, {3, 50}};
+    P.changeValues(changes.begin(), changes.end());
+    assert(P.size() == 5);
+    assert(P.maxKey() == 3 && P.maxValue() == 50);
+    std::vector<int> values;
+    for (PQ Q = P; !Q.empty(); Q.deleteMin()) values.push_back(Q.minValue());
+    assert(values.size() == 5 && values[4] == 50 && values[3] == 10);
+    assert(values[0] >= 1 && values[2] == 4);
+
+    // brakujący klucz - nic się nie zmienia
+    PQ backup = P;
+    std::vector<std::pair<int, int>> missing{{1, 0}, {9, 9}};
+    try {
+        P.changeValues(missing.begin(), missing.end());
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+    assert(P == backup);
+
+    std::vector<std::pair<int, int>> none;
+    P.changeValues(none.begin(), none.end());
+    P.insert_many(none.begin(), none.end());
+    assert(P == backup);
+}
+
+// Rzucające porównanie w operacjach na wielu parach nie psuje kolejki
+void testStrongGuarantee() {
+    std::vector<std::pair<int, Fragile>> pairs;
+    for (int i = 0; i < 100; ++i) pairs.emplace_back(i, Fragile{i % 10});
+
+    PriorityQueue<int, Fragile> P(pairs.begin(), pairs.begin() + 10);
+    auto backup = P;
+
+    throw_now = true;
+    expect_throw([&] { P.assign(pairs.begin(), pairs.end()); });
+    throw_now = false;
+    assert(P == backup);
+
+    P.assign(pairs.begin(), pairs.end());
+    assert(P.size() == 100);
+    assert(P.minValue().v == 0 && P.maxValue().v == 9);
+
+    backup = P;
+    std::vector<std::pair<int, Fragile>> changes{{1, Fragile{-1}},
+                                                 {2, Fragile{20}}};
+    throw_now = true;
+    expect_throw([&] { P.insert_many(pairs.begin(), pairs.begin() + 5); });
+    expect_throw([&] { P.changeValues(changes.begin(), changes.end()); });
+    throw_now = false;
+    assert(P == backup);
+
+    P.changeValues(changes.begin(), changes.end());
+    assert(P.size() == 100);
+    assert(P.minKey() == 1 && P.maxKey() == 2);
+}
+
+int main() {
+    testConstruction();
+    testBatches();
+    testStrongGuarantee();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+#include "test_common.hh"
+
+using PQ = PriorityQueue<int, int>;
+
+// Wszystkie trzy drogi changeValue: na miejscu, z przepięciem węzła
+// i z oderwaniem powtórzenia
+void testPaths() {
+    PQ P;
+    for (int i = 0; i < 10; ++i) P.insert(i, i * 10);
+
+    // między sąsiadami (30 i 50) - na miejscu
+    P.changeValue(4, 45);
+    assert(P.size() == 10);
+    // za maksimum i przed minimum - przepięcie
+    P.changeValue(0, 1000);
+    assert(P.maxKey() == 0 && P.minKey() == 1);
+    P.changeValue(9, -1);
+    assert(P.minKey() == 9 && P.minValue() == -1);
+    P.changeValue(5, 45);
+    P.deleteMin();
+    assert(P.size() == 9);
+
+    // powtórzenia pary (7, 70) - zmienia się tylko jedno
+    P.insert(7, 70);
+    P.insert(7, 70);
+    P.changeValue(7, 5);
+    assert(P.minKey() == 7 && P.minValue() == 5 && P.size() == 11);
+    P.deleteMin();
+    assert(P.minKey() == 1);
+    P.changeValue(7, 90);
+    P.deleteMax();
+    assert(P.maxKey() == 7 && P.maxValue() == 90);
+    P.deleteMax();
+
+    int expected[] = {10, 20, 30, 45, 45, 60, 70, 80};
+    for (int v : expected) {
+        assert(P.minValue() == v);
+        P.deleteMin();
+    }
+    assert(P.empty());
+
+    // jedyna para w kolejce
+    P.insert(1, 1);
+    P.changeValue(1, 2);
+    assert(P.minValue() == 2 && P.size() == 1);
+}
+
+// Rzucające porównanie wartości nie psuje kolejki
+void testStrongGuarantee() {
+    PriorityQueue<int, Fragile> P;
+    for (int i = 0; i < 20; ++i) P.insert(i, Fragile{i * 10});
+    P.insert(3, Fragile{30});
+    auto backup = P;
+
+    throw_now = true;
+    // na miejscu, z przepięciem i z oderwaniem powtórzenia
+    for (auto change : {std::make_pair(5, 55), std::make_pair(5, 500),
+                        std::make_pair(3, 500)}) {
+        Fragile value{change.second};
+        expect_throw([&] { P.changeValue(change.first, value); });
+    }
+    throw_now = false;
+    assert(P == backup);
+}
+
+template <typename V, typename MakeValue>
+void testRandom(MakeValue make_value) {
+    std::mt19937 twister(42);
+    PriorityQueue<int, V> P;
+    std::multiset<std::pair<V, int>> expected;  // (wartość, klucz)
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 4;
+        int key = twister() % 40;
+        V value = make_value(twister() % 60);
+        if (op == 0 || expected.size() < 20) {
+            P.insert(key, value);
+            expected.emplace(value, key);
+        } else if (op == 1) {
+            if (!expected.empty()) {
+                expected.erase(expected.begin());
+                P.deleteMin();
+            }
+        } else {
+            auto it = expected.begin();
+            while (it != expected.end() && it->second != key) ++it;
+            try {
+                P.changeValue(key, value);
+                assert(it != expected.end());
+            } catch (PriorityQueueNotFoundException&) {
+                assert(it == expected.end());
+                continue;
+            }
+            // zmieniona para jest dowolna, ale dokładnie jedna para
+            // o kluczu key zmieniła wartość na value
+            std::multiset<std::pair<V, int>> now;
+            auto copy = P;
+            assert(copy == P);
+            while (!copy.empty()) {
+                now.emplace(copy.minValue(), copy.minKey());
+                copy.deleteMin();
+            }
+            std::vector<std::pair<V, int>> removed, added;
+            std::set_difference(expected.begin(), expected.end(), now.begin(),
+                                now.end(), std::back_inserter(removed));
+            std::set_difference(now.begin(), now.end(), expected.begin(),
+                                expected.end(), std::back_inserter(added));
+            if (!removed.empty()) {
+                assert(removed.size() == 1 && removed[0].second == key);
+                assert(added.size() == 1 && added[0].second == key);
+                assert(added[0].first == value);
+            } else {
+                // para już miała wartość value
+                assert(added.empty());
+                assert(expected.count(std::make_pair(value, key)) > 0);
+            }
+            expected.swap(now);
+        }
+        assert(P.size() == expected.size());
+        if (!expected.empty()) {
+            assert(P.minValue() == expected.begin()->first);
+            assert(P.minKey() == expected.begin()->second);
+            assert(P.maxValue() == expected.rbegin()->first);
+        }
+    }
+}
+
+int main() {
+    testPaths();
+    testStrongGuarantee();
+    testRandom<int>([](int v) { return v; });
+    testRandom<std::string>(
+        [](int v) { return "shared value " + std::to_string(v); });
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
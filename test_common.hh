@@ -0,0 +1,138 @@
+#ifndef _JNP1_TEST_COMMON_HH_
+#define _JNP1_TEST_COMMON_HH_
+
+#include <cassert>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <utility>
+
+#include "priorityqueue.hh"
+
+// Wspólne części testów silników. Do sprawdzania silnej gwarancji: typy,
+// które rzucają Thrower, gdy ustawiono throw_now (każdy test to osobny
+// program, więc flaga może być zwykłą zmienną).
+static bool throw_now = false;
+struct Thrower {};
+
+// Liczba (klucz albo wartość), której porównanie rzuca
+struct Fragile {
+    int v;
+    bool operator<(const Fragile& other) const {
+        if (throw_now) throw Thrower();
+        return v < other.v;
+    }
+    bool operator==(const Fragile& other) const { return v == other.v; }
+};
+
+// Liczba, której kopia rzuca; bez przeniesienia
+struct FragileCopy {
+    int v;
+    explicit FragileCopy(int v) : v(v) {}
+    FragileCopy(const FragileCopy& other) : v(other.v) {
+        if (throw_now) throw Thrower();
+    }
+    bool operator<(const FragileCopy& other) const { return v < other.v; }
+    bool operator==(const FragileCopy& other) const { return v == other.v; }
+};
+
+// Komparator liczb, który rzuca
+struct FragileLess {
+    bool operator()(int lhs, int rhs) const {
+        if (throw_now) throw Thrower();
+        return lhs < rhs;
+    }
+};
+
+// Sprawdza, że f() rzuca Thrower
+template <typename F>
+void expect_throw(F f) {
+    try {
+        f();
+    } catch (const Thrower&) {
+        return;
+    }
+    assert(!"did not throw");
+}
+
+// Skrajne pary kolejki zgodne z multisetem expected par (wartość, klucz);
+// maksimum tylko w silnikach, które je znają
+template <typename Queue, typename Expected>
+void check_extremes(const Queue& P, const Expected& expected,
+                    std::false_type) {
+    assert(P.size() == expected.size());
+    if (!expected.empty()) assert(P.minValue() == expected.begin()->first);
+}
+
+template <typename Queue, typename Expected>
+void check_extremes(const Queue& P, const Expected& expected,
+                    std::true_type) {
+    check_extremes(P, expected, std::false_type());
+    if (!expected.empty()) assert(P.maxValue() == expected.rbegin()->first);
+}
+
+template <typename Queue, typename Expected>
+void remove_max(Queue&, Expected&, std::false_type) {}
+
+template <typename Queue, typename Expected>
+void remove_max(Queue& P, Expected& expected, std::true_type) {
+    if (expected.empty()) return;
+    expected.erase(expected.find(std::make_pair(P.maxValue(), P.maxKey())));
+    P.deleteMax();
+}
+
+// Losowe insert, deleteMin, merge i changeValue (a gdy WithMax - także
+// deleteMax) na kolejce Queue z kluczami i wartościami int, sprawdzane
+// z multisetem par (wartość, klucz)
+template <typename Queue, bool WithMax>
+void testRandomOperations() {
+    std::integral_constant<bool, WithMax> with_max;
+    std::mt19937 twister(42);
+    Queue P;
+    std::multiset<std::pair<int, int>> expected;
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 6;
+        int key = twister() % 50, value = twister() % 1000;
+        if (op <= 1) {
+            P.insert(key, value);
+            expected.emplace(value, key);
+        } else if (op == 2) {
+            if (!expected.empty()) {
+                expected.erase(expected.find(
+                    std::make_pair(P.minValue(), P.minKey())));
+                P.deleteMin();
+            }
+        } else if (op == 3) {
+            remove_max(P, expected, with_max);
+        } else if (op == 4) {
+            Queue other;
+            for (int j = twister() % 3; j > 0; --j) {
+                int k = twister() % 50, v = twister() % 1000;
+                other.insert(k, v);
+                expected.emplace(v, k);
+            }
+            P.merge(other);
+            assert(other.empty());
+        } else {
+            auto it = expected.begin();
+            while (it != expected.end() && it->second != key) ++it;
+            try {
+                P.changeValue(key, value);
+                assert(it != expected.end());
+            } catch (PriorityQueueNotFoundException&) {
+                assert(it == expected.end());
+                continue;
+            }
+            // zmieniona para jest dowolna - zsynchronizujmy się z kopią
+            Queue copy(P);
+            expected.clear();
+            while (!copy.empty()) {
+                expected.emplace(copy.minValue(), copy.minKey());
+                copy.deleteMin();
+            }
+        }
+        check_extremes(P, expected, with_max);
+    }
+}
+
+#endif /* end of include guard: _JNP1_TEST_COMMON_HH_ */
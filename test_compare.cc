@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+#include "test_common.hh"
+
+template <typename K, typename V, typename CompareK, typename CompareV>
+using CPQ = PriorityQueue<K, V, TreeBackend,
+                          std::allocator<std::pair<const K, V>>, CompareK,
+                          CompareV>;
+
+// Puste komparatory nie zajmują miejsca w kolejce
+static_assert(sizeof(CPQ<int, int, std::less<int>, std::greater<int>>) ==
+                  sizeof(PriorityQueue<int, int>),
+              "empty comparators should not grow the queue");
+
+void testReversed() {
+    using PQ = CPQ<int, int, std::less<int>, std::greater<int>>;
+    PQ P;
+    P.insert(1, 10);
+    P.insert(2, 30);
+    P.insert(3, 20);
+    // minimum według std::greater to największa liczba
+    assert(P.minKey() == 2 && P.minValue() == 30);
+    assert(P.maxKey() == 1 && P.maxValue() == 10);
+    P.changeValue(1, 40);
+    assert(P.minKey() == 1);
+    P.deleteMin();
+    assert(P.minValue() == 30);
+
+    std::vector<std::pair<int, int>> pairs = {{4, 5}, {5, 50}, {6, 25}};
+    P.insert_many(pairs.begin(), pairs.end());
+    std::vector<int> order;
+    while (!P.empty()) {
+        order.push_back(P.minValue());
+        P.deleteMin();
+    }
+    assert((order == std::vector<int>{50, 30, 25, 20, 5}));
+
+    PQ Q(pairs.begin(), pairs.end());
+    assert(Q.minKey() == 5 && Q.maxKey() == 4);
+}
+
+// Wartości porównywane po jednym polu
+struct Task {
+    std::string name;
+    int priority;
+};
+
+struct ByPriority {
+    bool operator()(const Task& lhs, const Task& rhs) const {
+        return lhs.priority < rhs.priority;
+    }
+};
+
+// Klucze porównywane bez względu na wielkość liter
+struct CaseInsensitive {
+    bool operator()(const std::string& lhs, const std::string& rhs) const {
+        return std::lexicographical_compare(
+            lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+            [](char a, char b) { return std::tolower(a) < std::tolower(b); });
+    }
+};
+
+void testProjection() {
+    CPQ<std::string, Task, CaseInsensitive, ByPriority> P;
+    P.insert("Ala", Task{"sleep", 5});
+    P.insert("Ola", Task{"eat", 2});
+    P.insert("Ela", Task{"code", 9});
+    assert(P.minValue().name == "eat" && P.maxValue().name == "code");
+
+    // "ALA" i "Ala" to ten sam klucz
+    P.changeValue("ALA", Task{"wake", 1});
+    assert(P.minKey() == "Ala" && P.minValue().name == "wake");
+    assert(P.size() == 3);
+    P.erase("ela");
+    assert(P.maxKey() == "Ola" && P.maxValue().name == "eat");
+    try {
+        P.changeValue("Ewa", Task{"none", 0});
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+}
+
+// Komparator ze stanem: kierunek porządku wybierany w czasie wykonania
+struct Direction {
+    bool reversed;
+    explicit Direction(bool reversed = false) : reversed(reversed) {}
+    bool operator()(int lhs, int rhs) const {
+        return reversed ? rhs < lhs : lhs < rhs;
+    }
+};
+
+using SPQ = CPQ<int, int, std::less<int>, Direction>;
+
+static_assert(sizeof(SPQ) > sizeof(PriorityQueue<int, int>),
+              "stateful comparator should be stored in the queue");
+
+// Przeniesienie kopiuje komparatory, więc nie jest noexcept, gdy ich kopia
+// może rzucić
+struct CopyMayThrow : std::less<int> {
+    CopyMayThrow() {}
+    CopyMayThrow(const CopyMayThrow&) {}
+};
+
+using TPQ = CPQ<int, int, std::less<int>, CopyMayThrow>;
+
+static_assert(std::is_nothrow_move_constructible<SPQ>::value &&
+                  std::is_nothrow_move_assignable<SPQ>::value,
+              "moving a queue with nothrow comparators should not throw");
+static_assert(!std::is_nothrow_move_constructible<TPQ>::value &&
+                  !std::is_nothrow_move_assignable<TPQ>::value,
+              "moving a queue may throw when its comparators may");
+
+void testStateful() {
+    SPQ P(std::less<int>(), Direction(true));
+    assert(P.value_comp().reversed);
+    for (int i = 0; i < 10; ++i) P.insert(i, i * 10);
+    assert(P.minValue() == 90 && P.maxValue() == 0);
+
+    // kopie, przeniesienia i partie zachowują komparator
+    SPQ copy(P);
+    assert(copy.value_comp().reversed && copy.minValue() == 90);
+    SPQ assigned;
+    assigned = P;
+    assert(assigned.value_comp().reversed && assigned.minValue() == 90);
+    SPQ moved(std::move(copy));
+    assert(moved.value_comp().reversed && moved.minValue() == 90);
+    assert(copy.value_comp().reversed && copy.empty());
+    copy.insert(1, 1);
+    copy.insert(2, 2);
+    assert(copy.minKey() == 2);
+
+    std::vector<std::pair<int, int>> pairs = {{20, 200}, {21, -5}};
+    P.insert_many(pairs.begin(), pairs.end());
+    assert(P.minKey() == 20 && P.maxKey() == 21);
+    std::vector<std::pair<int, int>> changes = {{20, -10}, {3, 500}};
+    P.changeValues(changes.begin(), changes.end());
+    assert(P.minKey() == 3 && P.maxKey() == 20);
+
+    SPQ other(std::less<int>(), Direction(true));
+    other.insert(30, 1000);
+    P.merge(other);
+    assert(other.empty() && other.value_comp().reversed);
+    assert(P.minKey() == 30);
+
+    // swap wymienia również komparatory
+    SPQ plain;
+    plain.insert(1, 1);
+    plain.insert(2, 2);
+    swap(P, plain);
+    assert(!P.value_comp().reversed && P.minKey() == 1);
+    assert(plain.value_comp().reversed && plain.minKey() == 30);
+
+    SPQ range(pairs.begin(), pairs.end(), std::less<int>(), Direction(true));
+    assert(range.minKey() == 20);
+}
+
+// Direction z operator== - merge kolejek z równymi komparatorami nie musi
+// wstawiać par od nowa
+struct ComparableDirection : Direction {
+    explicit ComparableDirection(bool reversed = false)
+        : Direction(reversed) {}
+    bool operator==(const ComparableDirection& other) const {
+        return reversed == other.reversed;
+    }
+};
+
+// Wszystkie wartości kolejki w kolejności kolejnych deleteMin()
+template <typename Queue>
+std::vector<int> drain(Queue& P) {
+    std::vector<int> values;
+    while (!P.empty()) {
+        values.push_back(P.minValue());
+        P.deleteMin();
+    }
+    return values;
+}
+
+// merge kolejek z różnym stanem komparatorów: wynik jest w porządku *this,
+// a obie kolejki zachowują swoje komparatory
+template <typename Compare>
+void testMergeDirections() {
+    using DPQ = CPQ<int, int, Compare, Compare>;
+    DPQ up, down(Compare(true), Compare(true));
+    for (int i = 0; i < 6; ++i) up.insert(i, 5 + 10 * i);
+    for (int i = 0; i < 6; ++i) down.insert(10 + i, 10 * i);
+    up.merge(down);
+    assert(down.empty() && down.value_comp().reversed);
+    assert(!up.value_comp().reversed && up.size() == 12);
+    assert(up.minValue() == 0 && up.maxValue() == 55);
+    std::vector<int> values = drain(up);
+    assert(std::is_sorted(values.begin(), values.end()));
+
+    // {15} i {10, 20}: minimum to 10 w porządku *this
+    DPQ one;
+    one.insert(1, 15);
+    DPQ two(Compare(true), Compare(true));
+    two.insert(2, 10);
+    two.insert(3, 20);
+    one.merge(two);
+    assert(one.minValue() == 10 && one.maxValue() == 20 && one.size() == 3);
+
+    // pusta kolejka nie przejmuje komparatorów scalanej
+    DPQ empty;
+    DPQ full(Compare(true), Compare(true));
+    for (int i = 0; i < 5; ++i) full.insert(i, i);
+    full.insert(4, 4);
+    empty.merge(full);
+    assert(!empty.value_comp().reversed && !empty.key_comp().reversed);
+    assert(full.empty() && full.value_comp().reversed);
+    assert(empty.minValue() == 0 && empty.maxKey() == 4 && empty.size() == 6);
+    values = drain(empty);
+    assert((values == std::vector<int>{0, 1, 2, 3, 4, 4}));
+
+    // ten sam stan - zwykłe scalanie, także do pustej kolejki
+    DPQ a(Compare(true), Compare(true)), b(Compare(true), Compare(true));
+    for (int i = 0; i < 5; ++i) b.insert(i, i);
+    a.merge(b);
+    assert(a.value_comp().reversed && a.minValue() == 4 && b.empty());
+    for (int i = 0; i < 5; ++i) b.insert(i, 10 + i);
+    a.merge(b);
+    values = drain(a);
+    assert((values == std::vector<int>{14, 13, 12, 11, 10, 4, 3, 2, 1, 0}));
+}
+
+// Rzucający komparator nie psuje kolejki
+void testStrongGuarantee() {
+    using FPQ = CPQ<int, int, FragileLess, FragileLess>;
+    FPQ P;
+    for (int i = 0; i < 50; ++i) P.insert(i % 10, i);
+    FPQ backup(P);
+    FPQ Q;
+    Q.insert(100, -1);
+    std::vector<std::pair<int, int>> pairs = {{3, 3}, {60, 60}};
+
+    throw_now = true;
+    expect_throw([&] { P.insert(50, -5); });
+    expect_throw([&] { P.changeValue(3, -3); });
+    expect_throw([&] { P.insert_many(pairs.begin(), pairs.end()); });
+    expect_throw([&] { P.merge(Q); });
+    throw_now = false;
+
+    assert(P == backup && Q.size() == 1);
+    P.merge(Q);
+    assert(P.minKey() == 100 && P.size() == 51);
+}
+
+// Odwrócony porządek wartości daje wyniki lustrzane względem domyślnego
+void testRandom() {
+    std::mt19937 twister(42);
+    CPQ<int, int, std::greater<int>, std::greater<int>> P;
+    std::multiset<std::pair<int, int>> expected;  // (-wartość, -klucz)
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 4;
+        int key = twister() % 50, value = twister() % 1000;
+        if (op <= 1) {
+            P.insert(key, value);
+            expected.emplace(-value, -key);
+        } else if (op == 2) {
+            if (!expected.empty()) {
+                assert(P.minValue() == -expected.begin()->first);
+                expected.erase(expected.find(
+                    std::make_pair(-P.minValue(), -P.minKey())));
+                P.deleteMin();
+            }
+        } else {
+            std::size_t c = 0;
+            for (auto it = expected.begin(); it != expected.end();)
+                if (it->second == -key) {
+                    it = expected.erase(it);
+                    ++c;
+                } else {
+                    ++it;
+                }
+            assert(P.erase_all(key) == c);
+        }
+        assert(P.size() == expected.size());
+        if (!expected.empty()) {
+            assert(P.minValue() == -expected.begin()->first);
+            assert(P.maxValue() == -expected.rbegin()->first);
+        }
+    }
+}
+
+int main() {
+    testReversed();
+    testProjection();
+    testStateful();
+    testMergeDirections<Direction>();
+    testMergeDirections<ComparableDirection>();
+    testStrongGuarantee();
+    testRandom();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <cassert>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrentpriorityqueue.hh"
+
+using CPQ = ConcurrentPriorityQueue<int, int>;
+
+void testBasic() {
+    CPQ P(4);
+    assert(P.empty());
+    try {
+        P.minValue();
+        assert(!"P.minValue() on empty P did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+    P.deleteMin();
+
+    for (int i = 0; i < 100; ++i) P.insert(i, (i * 37) % 100);
+    assert(P.size() == 100);
+    assert(P.minValue() == 0 && P.minKey() == 0);
+    assert(P.maxValue() == 99 && P.maxKey() == 27);
+
+    P.changeValue(50, -1);
+    assert(P.minKey() == 50);
+    P.changeValue(50, 1000);
+    assert(P.maxKey() == 50);
+    try {
+        P.changeValue(100, 1);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+
+    P.deleteMax();
+    assert(P.maxValue() == 99);
+    for (int last = -1; !P.empty(); P.deleteMin()) {
+        assert(P.minValue() > last);
+        last = P.minValue();
+    }
+    assert(P.size() == 0);
+}
+
+void testThreads() {
+    const int threads = 4, per_thread = 5000;
+    CPQ P(8);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&P, t] {
+            for (int i = 0; i < per_thread; ++i)
+                P.insert(t * per_thread + i, (i * 7919 + t) % 10007);
+        });
+    for (std::thread& w : workers) w.join();
+    workers.clear();
+    assert(P.size() == threads * per_thread);
+
+    // część wątków usuwa, część zmienia wartości
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&P, t] {
+            for (int i = 0; i < per_thread / 2; ++i) {
+                if (t % 2 == 0) {
+                    P.deleteMin();
+                } else {
+                    // para mogła już zostać usunięta przez inny wątek
+                    try {
+                        P.changeValue(t * per_thread + i, -i);
+                    } catch (const PriorityQueueNotFoundException&) {
+                    }
+                }
+            }
+        });
+    for (std::thread& w : workers) w.join();
+    assert(P.size() == threads * per_thread - threads / 2 * per_thread / 2);
+
+    int last = -per_thread, count = 0;
+    for (; !P.empty(); P.deleteMin(), ++count) {
+        assert(P.minValue() >= last);
+        last = P.minValue();
+    }
+    assert(count == threads * per_thread - threads / 2 * per_thread / 2);
+}
+
+// Wartość z dwóch słów - opis rozerwany przez równoległy zapis dałby różne
+// połówki
+struct Twin {
+    long a, b;
+    bool operator<(const Twin& other) const { return a < other.a; }
+};
+
+// Czytający widzą tylko całe pary, a minimum przy samych wstawieniach coraz
+// mniejszych wartości nie rośnie
+void testSummaries() {
+    const int writers = 3, per_thread = 20000;
+    ConcurrentPriorityQueue<int, Twin> P(4);
+    P.insert(0, Twin{0, 0});
+    std::atomic<bool> done{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < writers; ++t)
+        workers.emplace_back([&P, t] {
+            for (long i = 1; i <= per_thread; ++i)
+                P.insert(static_cast<int>(i * writers + t),
+                         Twin{-i * writers - t, -i * writers - t});
+        });
+    for (int t = 0; t < 2; ++t)
+        workers.emplace_back([&P, &done] {
+            long last = 0;
+            while (!done.load()) {
+                Twin min = P.minValue(), max = P.maxValue();
+                assert(min.a == min.b && max.a == max.b);
+                assert(min.a <= last && max.a == 0);
+                last = min.a;
+            }
+        });
+    for (int t = 0; t < writers; ++t) workers[t].join();
+    done.store(true);
+    for (std::size_t t = writers; t < workers.size(); ++t) workers[t].join();
+    assert(P.minValue().a == -per_thread * writers - (writers - 1));
+    assert(P.size() == writers * per_thread + 1);
+}
+
+// Typy nietrywialne - opisy części są kopiami par podmienianymi atomowo;
+// czytający widzą tylko całe wartości
+void testStrings() {
+    ConcurrentPriorityQueue<std::string, std::string> P(4);
+    try {
+        P.maxKey();
+        assert(!"P.maxKey() on empty P did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+    P.deleteMax();
+
+    const int threads = 4, per_thread = 2000;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&P, t] {
+            for (int i = 0; i < per_thread; ++i) {
+                std::string n = std::to_string(t * per_thread + i);
+                P.insert("key " + n, std::string(5 - n.size(), '0') + n);
+                if (i % 2) P.deleteMax();
+            }
+        });
+    std::thread reader([&P, &done] {
+        while (!done.load()) {
+            try {
+                assert(P.minValue().size() == 5);
+                assert(P.maxKey().compare(0, 4, "key ") == 0);
+            } catch (const PriorityQueueEmptyException&) {
+            }
+        }
+    });
+    for (std::thread& w : workers) w.join();
+    done.store(true);
+    reader.join();
+    assert(P.size() == threads * per_thread / 2);
+
+    std::string last;
+    for (; !P.empty(); P.deleteMin()) {
+        assert(P.minValue() >= last);
+        last = P.minValue();
+        assert(P.minKey() == "key " + std::to_string(std::stoi(last)));
+    }
+}
+
+int main() {
+    testBasic();
+    testThreads();
+    testSummaries();
+    testStrings();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
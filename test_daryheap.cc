@@ -0,0 +1,262 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "daryheap.hh"
+#include "test_common.hh"
+
+using PQ = HeapQueue<int, int, DaryHeapBackend<>>;
+
+PQ f(PQ q) { return q; }
+
+void testBasic() {
+    PQ P = f(PQ());
+    assert(P.empty());
+
+    P.insert(1, 42);
+    P.insert(2, 13);
+
+    assert(P.size() == 2);
+    assert(P.minKey() == 2);
+    assert(P.minValue() == 13);
+
+    PQ Q(f(P));
+    Q.deleteMin();
+    Q.deleteMin();
+    Q.deleteMin();
+    assert(Q.empty());
+
+    PQ R(Q);
+    R.insert(1, 100);
+    R.insert(2, 100);
+    R.insert(3, 300);
+
+    PQ S;
+    S = R;
+
+    try {
+        S.changeValue(4, 400);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+
+    S.changeValue(2, 200);
+    assert(S.minKey() == 1);
+    S.changeValue(3, 50);
+    assert(S.minKey() == 3 && S.minValue() == 50);
+
+    int last = 0;
+    while (!S.empty()) {
+        assert(S.minValue() >= last);
+        last = S.minValue();
+        S.deleteMin();
+    }
+    try {
+        S.minValue();
+        assert(!"S.minValue() on empty S did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+
+    PQ T;
+    T.insert(1, 1);
+    T.insert(2, 4);
+    S.insert(3, 9);
+    S.insert(4, 16);
+    S.changeValue(4, 15);
+    S.merge(T);
+    assert(S.size() == 4);
+    assert(S.minValue() == 1);
+    assert(T.empty());
+    S.changeValue(2, 0);
+    assert(S.minKey() == 2);
+
+    S = R;
+    swap(R, T);
+    assert(T == S);
+    assert(T != R);
+    assert(R < T);
+
+    R = std::move(S);
+    assert(T != S);
+    assert(T == R);
+}
+
+// Uchwyty przeżywają usuwanie innych par i scalanie; changeValue zwraca
+// nowy uchwyt zmienionej pary
+void testHandles() {
+    PQ P;
+    PQ::handle a = P.insert(1, 10);
+    PQ::handle b = P.insert(2, 20);
+    PQ::handle c = P.insert(1, 30);
+    assert(a != b && a != PQ::handle());
+    assert(P.key(c) == 1 && P.value(c) == 30);
+
+    // ten sam klucz w dwóch parach - uchwyt wybiera konkretną
+    c = P.changeValue(c, 5);
+    assert(P.minKey() == 1 && P.minValue() == 5 && P.value(c) == 5);
+    c = P.changeValue(c, 25);
+    assert(P.minValue() == 10 && P.value(a) == 10);
+
+    P.erase(a);
+    assert(P.size() == 2 && P.minKey() == 2 && P.value(c) == 25);
+
+    PQ Q;
+    PQ::handle d = Q.insert(4, 15);
+    Q.insert(5, 1);
+    P.merge(Q);
+    assert(Q.empty() && P.size() == 4);
+    d = P.changeValue(d, 0);
+    assert(P.minKey() == 4);
+    P.erase(d);
+    assert(P.minKey() == 5);
+
+    P.erase(b);
+    P.deleteMin();
+    assert(P.size() == 1 && P.minKey() == 1 && P.value(c) == 25);
+    P.erase(c);
+    assert(P.empty());
+}
+
+// Rzucające porównanie wartości nie psuje kolejki ani uchwytów
+void testStrongGuarantee() {
+    using VPQ = HeapQueue<int, Fragile, DaryHeapBackend<3>>;
+    VPQ P;
+    std::vector<VPQ::handle> handles;
+    for (int i = 0; i < 50; ++i)
+        handles.push_back(P.insert(i, Fragile{(i * 37) % 50}));
+    VPQ backup(P);
+    VPQ Q;
+    Q.insert(100, Fragile{-1});
+
+    throw_now = true;
+    expect_throw([&] { P.insert(50, Fragile{-5}); });
+    expect_throw([&] { P.deleteMin(); });
+    expect_throw([&] { P.changeValue(handles[20], Fragile{-3}); });
+    expect_throw([&] { P.erase(handles[3]); });
+    expect_throw([&] { P.merge(Q); });
+    throw_now = false;
+
+    assert(P == backup && Q.size() == 1);
+    assert(P.value(handles[20]) == Fragile{(20 * 37) % 50});
+    P.merge(Q);
+    assert(P.minKey() == 100);
+    P.erase(handles[3]);
+    assert(P.size() == 50);
+}
+
+// Wartość bez operatora przypisania, której kopia rzuca na żądanie
+bool throw_on_copy = false;
+struct Parts {
+    int x, parts;
+    Parts(int x, int parts) : x(x), parts(parts) {}
+    Parts(const Parts& other) : x(other.x), parts(other.parts) {
+        if (throw_on_copy) throw Thrower();
+    }
+    Parts& operator=(const Parts&) = delete;
+    bool operator<(const Parts& other) const { return x < other.x; }
+    bool operator==(const Parts& other) const {
+        return x == other.x && parts == other.parts;
+    }
+};
+
+void testChangeWithoutAssignment() {
+    using PPQ = HeapQueue<int, Parts, DaryHeapBackend<>>;
+    PPQ P;
+    PPQ::handle h = P.insert(1, Parts(7, 1));
+    for (int i = 2; i < 10; ++i) P.insert(i, Parts(i * 10, i));
+    PPQ backup(P);
+
+    throw_on_copy = true;
+    expect_throw([&] { P.changeValue(h, Parts(3, 5)); });
+    expect_throw([&] { P.changeValue(4, Parts(3, 5)); });
+    throw_on_copy = false;
+    assert(P == backup);
+    assert(P.value(h) == Parts(7, 1));
+
+    h = P.changeValue(h, Parts(100, 2));
+    assert(P.key(h) == 1 && P.value(h) == Parts(100, 2));
+    assert(P.minKey() == 2);
+    P.changeValue(5, Parts(3, 5));
+    assert(P.minKey() == 5 && P.minValue() == Parts(3, 5));
+}
+
+template <unsigned D>
+void testRandom() {
+    using DPQ = HeapQueue<int, int, DaryHeapBackend<D>>;
+    std::mt19937 twister(42 + D);
+    DPQ P;
+    // (wartość, klucz) i uchwyty żywych par
+    std::multiset<std::pair<int, int>> expected;
+    std::vector<typename DPQ::handle> handles;
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 6;
+        int key = twister() % 50, value = twister() % 1000;
+        if (op <= 1) {
+            handles.push_back(P.insert(key, value));
+            expected.emplace(value, key);
+        } else if (op == 2) {
+            if (!expected.empty()) {
+                assert(P.minValue() == expected.begin()->first);
+                expected.erase(expected.find(
+                    std::make_pair(P.minValue(), P.minKey())));
+                // usuwany uchwyt trzeba wyrzucić z listy; szukamy go po
+                // parze, a pary równe minimum są nierozróżnialne
+                for (std::size_t j = 0; j < handles.size(); ++j)
+                    if (P.value(handles[j]) == P.minValue() &&
+                        P.key(handles[j]) == P.minKey()) {
+                        P.erase(handles[j]);
+                        handles[j] = handles.back();
+                        handles.pop_back();
+                        break;
+                    }
+            }
+        } else if (op == 3) {
+            DPQ other;
+            for (int j = twister() % 5; j > 0; --j) {
+                int k = twister() % 50, v = twister() % 1000;
+                handles.push_back(other.insert(k, v));
+                expected.emplace(v, k);
+            }
+            P.merge(other);
+            assert(other.empty());
+        } else if (!handles.empty()) {
+            std::size_t j = twister() % handles.size();
+            typename DPQ::handle h = handles[j];
+            expected.erase(
+                expected.find(std::make_pair(P.value(h), P.key(h))));
+            if (op == 4) {
+                expected.emplace(value, P.key(h));
+                handles[j] = P.changeValue(h, value);
+            } else {
+                P.erase(h);
+                handles[j] = handles.back();
+                handles.pop_back();
+            }
+        }
+        assert(P.size() == expected.size() && handles.size() == P.size());
+        if (!expected.empty())
+            assert(P.minValue() == expected.begin()->first);
+    }
+    DPQ copy(P);
+    assert(copy == P);
+    while (!copy.empty()) {
+        assert(copy.minValue() == expected.begin()->first);
+        expected.erase(expected.begin());
+        copy.deleteMin();
+    }
+}
+
+int main() {
+    testBasic();
+    testHandles();
+    testStrongGuarantee();
+    testChangeWithoutAssignment();
+    testRandom<2>();
+    testRandom<4>();
+    testRandom<8>();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "priorityqueue.hh"
+#include "test_common.hh"
+
+using PQ = PriorityQueue<int, int>;
+
+void testBasic() {
+    PQ P;
+    P.insert(1, 10);
+    P.insert(1, 20);
+    P.insert(2, 10);
+    P.insert(2, 10);
+    P.insert(3, 30);
+
+    try {
+        P.erase(4);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+    try {
+        P.erase(3, 10);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+    assert(P.size() == 5);
+
+    // jedno powtórzenie pary (2, 10)
+    P.erase(2, 10);
+    assert(P.size() == 4);
+    P.erase(3);
+    assert(P.size() == 3 && P.maxValue() == 20);
+
+    assert(P.erase_all(5) == 0);
+    assert(P.erase_all(1) == 2);
+    assert(P.size() == 1 && P.minKey() == 2 && P.maxKey() == 2);
+    P.erase(2);
+    assert(P.empty());
+
+    try {
+        P.erase(2);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+}
+
+// Klucz na skraju drzewa i kolejka złożona z jednego klucza
+void testEraseAll() {
+    PQ P;
+    for (int i = 0; i < 100; ++i) P.insert(i % 5, i);
+    P.insert(0, 0);
+    assert(P.erase_all(0) == 21);
+    assert(P.erase_all(4) == 20);
+    assert(P.size() == 60);
+    assert(P.minKey() == 1 && P.maxKey() == 3);
+
+    PQ Q;
+    for (int i = 0; i < 10; ++i) Q.insert(7, i % 3);
+    assert(Q.erase_all(7) == 10 && Q.empty());
+    Q.insert(7, 1);
+    assert(Q.minKey() == 7 && Q.size() == 1);
+}
+
+// Rzucające porównanie kluczy nie psuje kolejki
+void testStrongGuarantee() {
+    PriorityQueue<Fragile, int> P;
+    for (int i = 0; i < 50; ++i) P.insert(Fragile{i % 10}, i);
+    auto backup = P;
+
+    throw_now = true;
+    expect_throw([&] { P.erase(Fragile{3}); });
+    expect_throw([&] { P.erase(Fragile{3}, 13); });
+    expect_throw([&] { P.erase_all(Fragile{3}); });
+    throw_now = false;
+    assert(P == backup);
+
+    P.erase(Fragile{3}, 13);
+    assert(P.erase_all(Fragile{3}) == 4);
+    assert(P.size() == 45);
+}
+
+void testRandom() {
+    std::mt19937 twister(42);
+    PriorityQueue<std::string, int> P;
+    std::multiset<std::pair<int, std::string>> expected;  // (wartość, klucz)
+    auto count_key = [&expected](const std::string& key) {
+        std::size_t c = 0;
+        for (const auto& p : expected) c += p.second == key;
+        return c;
+    };
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 5;
+        std::string key = "key " + std::to_string(twister() % 30);
+        int value = twister() % 20;
+        if (op <= 1) {
+            P.insert(key, value);
+            expected.emplace(value, key);
+        } else if (op == 2) {
+            auto it = expected.find(std::make_pair(value, key));
+            try {
+                P.erase(key, value);
+                assert(it != expected.end());
+                expected.erase(it);
+            } catch (PriorityQueueNotFoundException&) {
+                assert(it == expected.end());
+            }
+        } else if (op == 3) {
+            std::size_t c = count_key(key);
+            assert(P.erase_all(key) == c);
+            for (auto it = expected.begin(); it != expected.end();)
+                it = it->second == key ? expected.erase(it) : std::next(it);
+        } else {
+            std::size_t c = count_key(key);
+            try {
+                P.erase(key);
+                assert(c > 0);
+            } catch (PriorityQueueNotFoundException&) {
+                assert(c == 0);
+                continue;
+            }
+            // usunięta para jest dowolna - zsynchronizujmy się z kopią
+            auto copy = P;
+            expected.clear();
+            while (!copy.empty()) {
+                expected.emplace(copy.minValue(), copy.minKey());
+                copy.deleteMin();
+            }
+            assert(count_key(key) == c - 1);
+        }
+        check_extremes(P, expected, std::true_type());
+    }
+}
+
+int main() {
+    testBasic();
+    testEraseAll();
+    testStrongGuarantee();
+    testRandom();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -129,6 +129,9 @@ int main() {
     } catch(const bad_alloc &e) {
       exceptions_on = exceptions_none;
       cout << "Allocation failed - exception possible." << endl;
+    } catch(my_exception &e) {
+      // OK - pairs are copied, so the copy ctor of K/V may throw
+      exceptions_on = exceptions_none;
     } catch(...) {
       exceptions_on = exceptions_none;
       cout << "There should be no exception." << endl;
@@ -183,6 +186,18 @@ int main() {
           cout << "Copying not performed correctly." << endl;
         }
       }
+    } catch(my_exception &e) {
+      // OK - pairs are copied, so the copy ctor of K/V may throw
+      exceptions_on = exceptions_none;
+      if(r.size() != 2) {
+        cout << "No rollback after exception." << endl;
+      } else {
+        if(r.minKey() == 2 && r.minValue() == 200 && r.maxKey() == 3 && r.maxValue() == 300) {
+          // OK
+        } else {
+          cout << "Rollback not performed correctly." << endl;
+        }
+      }
     } catch(...) {
       exceptions_on = exceptions_none;
       cout << "There should be no exception." << endl;
@@ -240,18 +255,16 @@ int main() {
     mad_queue q;
     q.insert(mc(1), mc(100));
     try {
+      // the removed pair is linked into every index - no comparisons needed
       exceptions_on = 1<<7;
       q.deleteMin();
       exceptions_on = 0;
-      cout << "Exception lost." << endl;
+      if(q.size() != 0) {
+        cout << "deleteMin() did not remove the pair." << endl;
+      }
     } catch(my_exception &e) {
-      // caught
       exceptions_on = 0;
-      if(q.size() == 1) {
-        //cout << "Exception safety is OK." << endl;
-      } else {
-        cout << "Missing rollback after exception." << endl;
-      }
+      cout << "deleteMin() should not compare anything." << endl;
     }
   }
 
@@ -262,18 +275,16 @@ int main() {
     mad_queue q;
     q.insert(mc(1), mc(100));
     try {
+      // the removed pair is linked into every index - no comparisons needed
       exceptions_on = 1<<7;
       q.deleteMax();
       exceptions_on = 0;
-      cout << "Exception lost." << endl;
+      if(q.size() != 0) {
+        cout << "deleteMax() did not remove the pair." << endl;
+      }
     } catch(my_exception &e) {
-      // caught
       exceptions_on = 0;
-      if(q.size() == 1) {
-        //cout << "Exception safety is OK." << endl;
-      } else {
-        cout << "Missing rollback after exception." << endl;
-      }
+      cout << "deleteMax() should not compare anything." << endl;
     }
   }
   //
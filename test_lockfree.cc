@@ -0,0 +1,263 @@
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "lockfreepriorityqueue.hh"
+
+using LFPQ = LockFreePriorityQueue<int, int>;
+
+void testBasic() {
+    LFPQ P;
+    assert(P.empty());
+    int key, value;
+    assert(!P.popMin(key, value));
+    try {
+        P.minValue();
+        assert(!"P.minValue() on empty P did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+
+    for (int i = 0; i < 1000; ++i) P.insert(i, (i * 37) % 1000);
+    assert(P.size() == 1000);
+    assert(P.minValue() == 0 && P.minKey() == 0);
+    assert(P.maxValue() == 999 && P.maxKey() == 27);
+
+    for (int i = 0; i < 1000; ++i) {
+        assert(P.popMin(key, value));
+        assert(value == i && (key * 37) % 1000 == i);
+        if (i < 999) assert(P.maxValue() == 999);
+    }
+    assert(P.empty());
+    assert(!P.popMin(key, value));
+
+    // równe pary są osobnymi węzłami
+    P.insert(1, 1);
+    P.insert(1, 1);
+    P.deleteMin();
+    assert(P.size() == 1 && P.minValue() == 1);
+}
+
+// Każda wstawiona para jest zdejmowana dokładnie raz
+void testThreads() {
+    const int threads = 4, per_thread = 5000;
+    LFPQ P;
+    std::vector<std::vector<int>> popped(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&P, &popped, t] {
+            std::mt19937 twister(t);
+            int key, value;
+            for (int i = 0; i < per_thread; ++i) {
+                P.insert(t * per_thread + i, twister() % 1000);
+                if (i % 3 == 1 && P.popMin(key, value))
+                    popped[t].push_back(key);
+                if (i % 3 == 2 && P.popMin(key, value))
+                    popped[t].push_back(key);
+            }
+        });
+    for (std::thread& w : workers) w.join();
+
+    std::vector<int> all;
+    for (std::vector<int>& p : popped) all.insert(all.end(), p.begin(), p.end());
+    int key, value, last = -1;
+    while (P.popMin(key, value)) {
+        assert(value >= last);
+        last = value;
+        all.push_back(key);
+    }
+    assert(all.size() == threads * per_thread);
+    std::vector<bool> seen(threads * per_thread, false);
+    for (int k : all) {
+        assert(!seen[k]);
+        seen[k] = true;
+    }
+}
+
+// Kończące się wątki oddają sloty, więc kolejno może ich przyjść dowolnie
+// wiele; wątek przeplatający dwie kolejki ma slot w każdej z nich
+void testThreadExit() {
+    // główny wątek nie dotyka P, więc oba sloty są dla robotników
+    LFPQ P(2), Q(2);
+    for (int round = 0; round < 50; ++round) {
+        std::thread worker([&P, &Q, round] {
+            int key, value;
+            for (int i = 0; i < 200; ++i) {
+                P.insert(round * 200 + i, i);
+                Q.insert(i, round);
+                // odłożone węzły zostają po wątku w domenie
+                if (i % 2) assert(P.popMin(key, value) && value < 1000);
+                if (i % 4 == 3) Q.deleteMin();
+            }
+        });
+        std::thread other([&P] { P.insert(-1, 1000); });
+        worker.join();
+        other.join();
+    }
+    assert(P.size() == 50 * 101 && Q.size() == 50 * 150);
+
+    // z trzema żywymi wątkami naraz slotów nie starcza
+    std::atomic<int> ready{0}, failed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 3; ++t)
+        workers.emplace_back([&] {
+            ++ready;
+            while (ready.load() < 3) std::this_thread::yield();
+            try {
+                P.deleteMin();
+            } catch (const PriorityQueueThreadLimitException&) {
+                ++failed;
+            }
+            ++ready;
+            while (ready.load() < 6) std::this_thread::yield();
+        });
+    for (std::thread& w : workers) w.join();
+    // główny wątek nie ma slotu w P
+    assert(failed.load() == 1);
+}
+
+// Sprawdzanie liniowalności (Wing, Gong): zapisujemy historię krótkich
+// współbieżnych operacji z momentami wywołania i powrotu, a potem szukamy
+// kolejności sekwencyjnej zgodnej z czasem rzeczywistym i z modelem
+// (multiset par (wartość, klucz)).
+struct operation {
+    enum { insert, pop_min, min_value, max_value } kind;
+    int key, value;
+    bool ok;
+    unsigned long invoked, returned;
+};
+
+using model = std::multiset<std::pair<int, int>>;
+
+bool apply(const operation& op, model& m) {
+    switch (op.kind) {
+        case operation::insert:
+            m.emplace(op.value, op.key);
+            return true;
+        case operation::pop_min:
+            if (m.empty()) return !op.ok;
+            if (!op.ok || *m.begin() != std::make_pair(op.value, op.key))
+                return false;
+            m.erase(m.begin());
+            return true;
+        case operation::min_value:
+            if (m.empty()) return !op.ok;
+            return op.ok && m.begin()->first == op.value;
+        case operation::max_value:
+            if (m.empty()) return !op.ok;
+            return op.ok && std::prev(m.end())->first == op.value;
+    }
+    return false;
+}
+
+bool linearizable(const std::vector<operation>& ops, unsigned done, model& m,
+                  std::set<unsigned>& failed) {
+    if (done == (1u << ops.size()) - 1) return true;
+    if (failed.count(done)) return false;
+    unsigned long horizon = ~0ul;
+    for (std::size_t i = 0; i < ops.size(); ++i)
+        if (!(done & (1u << i)) && ops[i].returned < horizon)
+            horizon = ops[i].returned;
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        if ((done & (1u << i)) || ops[i].invoked > horizon) continue;
+        model next = m;
+        if (apply(ops[i], next) &&
+            linearizable(ops, done | (1u << i), next, failed))
+            return true;
+    }
+    failed.insert(done);
+    return false;
+}
+
+void testLinearizability(int rounds) {
+    const int threads = 3, per_thread = 4;
+    std::mt19937 twister(2024);
+    for (int round = 0; round < rounds; ++round) {
+        LFPQ P;
+        model initial;
+        for (int i = 0; i < 3; ++i) {
+            int value = twister() % 5;
+            P.insert(-1 - i, value);
+            initial.emplace(value, -1 - i);
+        }
+
+        std::vector<std::vector<operation>> plans(threads);
+        for (int t = 0; t < threads; ++t)
+            for (int i = 0; i < per_thread; ++i) {
+                operation op{};
+                op.kind = static_cast<decltype(op.kind)>(twister() % 4);
+                op.key = t * per_thread + i;
+                op.value = twister() % 5;
+                plans[t].push_back(op);
+            }
+
+        std::atomic<unsigned long> clock{0};
+        std::atomic<int> ready{0};
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&, t] {
+                ++ready;
+                while (ready.load() < threads) std::this_thread::yield();
+                for (operation& op : plans[t]) {
+                    // na jednym rdzeniu wątki inaczej rzadko się przeplatają
+                    std::this_thread::yield();
+                    op.invoked = clock++;
+                    switch (op.kind) {
+                        case operation::insert:
+                            P.insert(op.key, op.value);
+                            op.ok = true;
+                            break;
+                        case operation::pop_min:
+                            op.ok = P.popMin(op.key, op.value);
+                            break;
+                        case operation::min_value:
+                            try {
+                                op.value = P.minValue();
+                                op.ok = true;
+                            } catch (const PriorityQueueEmptyException&) {
+                                op.ok = false;
+                            }
+                            break;
+                        case operation::max_value:
+                            try {
+                                op.value = P.maxValue();
+                                op.ok = true;
+                            } catch (const PriorityQueueEmptyException&) {
+                                op.ok = false;
+                            }
+                            break;
+                    }
+                    op.returned = clock++;
+                }
+            });
+        for (std::thread& w : workers) w.join();
+
+        std::vector<operation> history;
+        for (std::vector<operation>& plan : plans)
+            history.insert(history.end(), plan.begin(), plan.end());
+        std::set<unsigned> failed;
+        if (!linearizable(history, 0, initial, failed)) {
+            std::cout << "Not linearizable (round " << round << "):" << std::endl;
+            for (const operation& op : history)
+                std::cout << "  [" << op.invoked << ", " << op.returned
+                          << "] kind " << op.kind << " key " << op.key
+                          << " value " << op.value << " ok " << op.ok
+                          << std::endl;
+            assert(!"history is not linearizable");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    testBasic();
+    testThreads();
+    testThreadExit();
+    testLinearizability(argc > 1 ? std::atoi(argv[1]) : 2000);
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,114 @@
+#include <cassert>
+#include <iostream>
+
+#include "minmaxheap.hh"
+#include "test_common.hh"
+
+using PQ = PriorityQueue<int, int, MinMaxHeapBackend>;
+
+PQ f(PQ q) { return q; }
+
+void testBasic() {
+    PQ P = f(PQ());
+    assert(P.empty());
+
+    P.insert(1, 42);
+    P.insert(2, 13);
+
+    assert(P.size() == 2);
+    assert(P.minKey() == 2);
+    assert(P.minValue() == 13);
+
+    PQ Q(f(P));
+    Q.deleteMin();
+    Q.deleteMin();
+    Q.deleteMin();
+    assert(Q.empty());
+
+    PQ R(Q);
+    R.insert(1, 100);
+    R.insert(2, 100);
+    R.insert(3, 300);
+
+    PQ S;
+    S = R;
+
+    try {
+        S.changeValue(4, 400);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+
+    S.changeValue(2, 200);
+    assert(S.minKey() == 1);
+    S.changeValue(3, 50);
+    assert(S.minKey() == 3 && S.minValue() == 50);
+
+    int last = 0;
+    while (!S.empty()) {
+        assert(S.minValue() >= last);
+        last = S.minValue();
+        S.deleteMin();
+    }
+    try {
+        S.minValue();
+        assert(!"S.minValue() on empty S did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+
+    PQ T;
+    T.insert(1, 1);
+    T.insert(2, 4);
+    S.insert(3, 9);
+    S.insert(4, 16);
+    S.changeValue(4, 15);
+    S.merge(T);
+    assert(S.size() == 4);
+    assert(S.minValue() == 1);
+    assert(T.empty());
+    S.changeValue(2, 0);
+    assert(S.minKey() == 2);
+
+    S = R;
+    swap(R, T);
+    assert(T == S);
+    assert(T != R);
+    assert(R < T);
+
+    R = std::move(S);
+    assert(T != S);
+    assert(T == R);
+}
+
+// Rzucające porównanie nie psuje kolejki
+void testStrongGuarantee() {
+    PriorityQueue<int, Fragile, MinMaxHeapBackend> P;
+    for (int i = 0; i < 20; ++i) P.insert(i, Fragile{(i * 7) % 20});
+    auto backup = P;
+    PriorityQueue<int, Fragile, MinMaxHeapBackend> Q;
+    Q.insert(100, Fragile{-5});
+    Q.insert(101, Fragile{50});
+
+    throw_now = true;
+    expect_throw([&] { P.deleteMin(); });
+    expect_throw([&] { P.changeValue(3, Fragile{-1}); });
+    expect_throw([&] { P.insert(100, Fragile{-5}); });
+    expect_throw([&] { P.deleteMax(); });
+    expect_throw([&] { P.merge(Q); });
+    throw_now = false;
+    assert(Q.size() == 2);
+
+    assert(P == backup);
+    for (int i = 0; i < 20; ++i) {
+        assert(P.minValue().v == i);
+        P.deleteMin();
+    }
+}
+
+int main() {
+    testBasic();
+    testStrongGuarantee();
+    testRandomOperations<PQ, true>();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
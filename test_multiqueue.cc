@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "multiqueue.hh"
+
+using MQ = MultiQueue<int, int>;
+
+void testSingleQueue() {
+    // z jedną kolejką wewnętrzną popMin zwraca dokładne minimum
+    MQ P(1);
+    int key, value;
+    assert(!P.popMin(key, value));
+    for (int i = 0; i < 100; ++i) P.insert(i, (i * 37) % 100);
+    assert(P.size() == 100);
+    for (int i = 0; i < 100; ++i) {
+        assert(P.popMin(key, value));
+        assert(value == i && (key * 37) % 100 == i);
+    }
+    assert(P.empty());
+}
+
+void testRelaxed() {
+    MQ P(8, 2);
+    assert(P.queues() == 8);
+    std::vector<int> popped;
+    for (int i = 0; i < 1000; ++i) P.insert(i, i);
+    P.deleteMin();
+    int key, value;
+    while (P.popMin(key, value)) {
+        assert(key == value);
+        popped.push_back(value);
+    }
+    assert(popped.size() == 999);
+    std::sort(popped.begin(), popped.end());
+    assert(std::unique(popped.begin(), popped.end()) == popped.end());
+}
+
+void testThreads() {
+    const int threads = 4, per_thread = 5000;
+    MQ P(16);
+    std::vector<std::vector<int>> popped(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&P, &popped, t] {
+            int key, value;
+            for (int i = 0; i < per_thread; ++i) {
+                P.insert(t * per_thread + i, i);
+                if (i % 2 == 1 && P.popMin(key, value))
+                    popped[t].push_back(key);
+            }
+        });
+    for (std::thread& w : workers) w.join();
+
+    std::vector<int> all;
+    for (std::vector<int>& p : popped) all.insert(all.end(), p.begin(), p.end());
+    int key, value;
+    while (P.popMin(key, value)) all.push_back(key);
+    assert(all.size() == threads * per_thread);
+    std::sort(all.begin(), all.end());
+    for (int i = 0; i < threads * per_thread; ++i) assert(all[i] == i);
+}
+
+// Dwie pary w wielu kolejkach - losowania zwykle nie trafiają, a po nich
+// remove_small bierze dokładne minimum, a nie pierwszą niepustą kolejkę
+void testFewParts() {
+    const int trials = 2000;
+    int exact = 0;
+    for (int trial = 0; trial < trials; ++trial) {
+        MQ P(1000, 1);
+        P.insert(0, 2);
+        P.insert(1, 1);
+        int key, value;
+        assert(P.popMin(key, value));
+        if (value == 1) ++exact;
+        assert(P.popMin(key, value) && !P.popMin(key, value));
+    }
+    // losowania trafiają w jedną z par w ok. 12% prób
+    assert(exact > trials * 3 / 4);
+}
+
+// Duża rywalizacja przy kilku parach: każdy wątek wstawia i zaraz usuwa,
+// więc kolejka nigdy nie jest pusta, gdy wątek usuwa
+void testContention() {
+    const int threads = 4, per_thread = 3000;
+    MQ P(256, 2);
+    std::vector<std::vector<int>> popped(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t)
+        workers.emplace_back([&P, &popped, t] {
+            int key, value;
+            for (int i = 0; i < per_thread; ++i) {
+                P.insert(t * per_thread + i, i);
+                assert(P.popMin(key, value));
+                popped[t].push_back(key);
+            }
+        });
+    for (std::thread& w : workers) w.join();
+    assert(P.empty());
+
+    std::vector<int> all;
+    for (std::vector<int>& p : popped) all.insert(all.end(), p.begin(), p.end());
+    std::sort(all.begin(), all.end());
+    for (int i = 0; i < threads * per_thread; ++i) assert(all[i] == i);
+}
+
+int main() {
+    testSingleQueue();
+    testRelaxed();
+    testThreads();
+    testFewParts();
+    testContention();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+using PQ = PriorityQueue<int, int, RankedTreeBackend>;
+using Pairs = std::vector<std::pair<int, int>>;
+
+// Pary (klucz, wartość) w kolejności iteratora
+template <typename It>
+Pairs collect(It first, It last) {
+    Pairs out;
+    for (; first != last; ++first)
+        out.emplace_back(first->first, (*first).second);
+    return out;
+}
+
+void testBasic() {
+    PQ P;
+    assert(P.begin() == P.end() && P.key_begin() == P.key_end());
+    assert(P.nth_by_value(0) == P.end());
+    assert(P.rank(5) == 0 && P.count_in_range(0, 10) == 0);
+
+    P.insert(3, 30);
+    P.insert(1, 20);
+    P.insert(2, 20);
+    P.insert(1, 20);
+    P.insert(5, 10);
+    P.insert(4, 40);
+
+    Pairs by_value = {{5, 10}, {1, 20}, {1, 20}, {2, 20}, {3, 30}, {4, 40}};
+    assert(collect(P.begin(), P.end()) == by_value);
+    assert(collect(P.cbegin(), P.cend()) == by_value);
+    assert(std::distance(P.begin(), P.end()) == 6);
+    // równe klucze - w kolejności wstawienia
+    Pairs by_key = {{1, 20}, {1, 20}, {2, 20}, {3, 30}, {4, 40}, {5, 10}};
+    assert(collect(P.key_begin(), P.key_end()) == by_key);
+
+    // wstecz od end(), także przez powtórzenia
+    Pairs backwards;
+    for (auto it = P.end(); it != P.begin();) {
+        --it;
+        backwards.emplace_back((*it).first, (*it).second);
+    }
+    std::reverse(backwards.begin(), backwards.end());
+    assert(backwards == by_value);
+    auto it = P.begin();
+    assert(it++ == P.begin() && (*it).second == 20);
+    assert(--(++it) == std::next(P.begin()));
+
+    for (std::size_t i = 0; i < by_value.size(); ++i) {
+        auto nth = P.nth_by_value(i);
+        assert(nth == std::next(P.begin(), i));
+        assert(nth->first == by_value[i].first);
+    }
+    assert(P.nth_by_value(6) == P.end());
+
+    assert(P.rank(5) == 0 && P.rank(10) == 0 && P.rank(15) == 1);
+    assert(P.rank(20) == 1 && P.rank(21) == 4 && P.rank(100) == 6);
+    assert(P.count_in_range(20, 20) == 3);
+    assert(P.count_in_range(10, 30) == 5);
+    assert(P.count_in_range(11, 39) == 4);
+    assert(P.count_in_range(0, 100) == 6);
+    assert(P.count_in_range(30, 20) == 0);
+    assert(P.count_in_range(41, 50) == 0);
+
+    // powtórzenie schodzi - pozycje się przesuwają
+    P.erase(1, 20);
+    assert(P.rank(30) == 3 && P.nth_by_value(2)->first == 2);
+    P.changeValue(5, 35);
+    assert(P.rank(30) == 2 && P.nth_by_value(3)->first == 5);
+    assert(P.count_in_range(20, 35) == 4);
+}
+
+// Komparator wartości odwraca porządek, więc i pozycje
+void testComparator() {
+    PriorityQueue<int, int, RankedTreeBackend,
+                  std::allocator<std::pair<const int, int>>, std::less<int>,
+                  std::greater<int>>
+        P;
+    for (int i = 0; i < 10; ++i) P.insert(i, i);
+    assert(P.begin()->second == 9 && P.key_begin()->first == 0);
+    assert(P.rank(7) == 2 && P.nth_by_value(2)->second == 7);
+    assert(P.count_in_range(7, 3) == 5 && P.count_in_range(3, 7) == 0);
+}
+
+void testStrings() {
+    PriorityQueue<std::string, std::string, RankedTreeBackend> P;
+    P.insert("b", "long value number one");
+    P.insert("a", "long value number two");
+    P.insert("c", "long value number one");
+    std::vector<std::string> keys;
+    for (auto it = P.begin(); it != P.end(); ++it) keys.push_back(it->first);
+    assert((keys == std::vector<std::string>{"b", "c", "a"}));
+    assert(P.key_begin()->second == "long value number two");
+    assert(P.rank("long value number two") == 2);
+}
+
+// Iteratory nie potrzebują statystyk pozycyjnych
+void testPlain() {
+    PriorityQueue<int, int> P;
+    Pairs pairs = {{2, 5}, {1, 5}, {3, 1}, {2, 5}};
+    P.insert_many(pairs.begin(), pairs.end());
+    assert((collect(P.begin(), P.end()) == Pairs{{3, 1}, {1, 5}, {2, 5},
+                                                  {2, 5}}));
+    assert((collect(P.key_begin(), P.key_end()) ==
+            Pairs{{1, 5}, {2, 5}, {2, 5}, {3, 1}}));
+    auto last = std::prev(P.end());
+    assert(last->first == 2 && std::prev(last)->first == 2);
+    assert(std::prev(P.key_end())->first == 3);
+    // kopia ma te same pary w tej samej kolejności
+    PriorityQueue<int, int> copy(P);
+    assert(std::equal(P.begin(), P.end(), copy.begin()));
+}
+
+// Iteratory, pozycje i przedziały zgadzają się z posortowanym modelem po
+// każdej operacji zmieniającej kolejkę
+void testRandom() {
+    std::mt19937 twister(42);
+    PQ P;
+    std::multiset<std::pair<int, int>> expected;  // (wartość, klucz)
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 10;
+        int key = twister() % 40, value = twister() % 60;
+        if (op <= 2 || expected.size() < 10) {
+            P.insert(key, value);
+            expected.emplace(value, key);
+        } else if (op == 3) {
+            P.deleteMin();
+            expected.erase(expected.begin());
+        } else if (op == 4) {
+            P.deleteMax();
+            expected.erase(std::prev(expected.end()));
+        } else if (op == 5) {
+            try {
+                P.changeValue(key, value);
+            } catch (PriorityQueueNotFoundException&) {
+            }
+        } else if (op == 6) {
+            P.erase_all(key);
+        } else if (op == 7) {
+            PQ other;
+            for (int j = 0; j < 5; ++j) other.insert(twister() % 40, j * 10);
+            other.insert(key, value);
+            if (twister() % 2)
+                P.merge(other);
+            else
+                P.insert_many(other.begin(), other.end());
+        } else if (op == 8) {
+            Pairs pairs = {{key, value}, {key, value}, {key + 1, value}};
+            P.insert_many(pairs.begin(), pairs.end());
+        } else if (twister() % 20 == 0) {
+            // ograniczenie usuwa najmniejsze pary, potem znika
+            P.set_capacity(P.size() / 2);
+            P.insert(key, value);
+            P.set_capacity(std::numeric_limits<PQ::size_type>::max());
+        } else {
+            P = PQ(P);
+        }
+
+        // model odtwarzamy z iteracji po kluczach, a porządek wartości
+        // sprawdzamy względem niego
+        std::multiset<std::pair<int, int>> now;
+        int last_key = -1;
+        for (auto it = P.key_begin(); it != P.key_end(); ++it) {
+            assert(it->first >= last_key);
+            last_key = it->first;
+            now.emplace(it->second, it->first);
+        }
+        expected.swap(now);
+        assert(P.size() == expected.size());
+        Pairs by_value;
+        for (const auto& p : expected) by_value.emplace_back(p.second, p.first);
+        assert(collect(P.begin(), P.end()) == by_value);
+        assert(P.minValue() == by_value.front().second);
+        assert(P.maxKey() == by_value.back().first);
+
+        for (int probe = 0; probe < 4; ++probe) {
+            int v = static_cast<int>(twister() % 70) - 5;
+            int w = static_cast<int>(twister() % 70) - 5;
+            std::size_t below = std::distance(
+                expected.begin(), expected.lower_bound(std::make_pair(v, -1)));
+            assert(P.rank(v) == below);
+            std::size_t in_range = 0;
+            for (const auto& p : expected)
+                if (v <= p.first && p.first <= w) ++in_range;
+            assert(P.count_in_range(v, w) == in_range);
+            std::size_t n = twister() % (expected.size() + 2);
+            auto nth = P.nth_by_value(n);
+            if (n < by_value.size())
+                assert(nth->first == by_value[n].first &&
+                       nth->second == by_value[n].second);
+            else
+                assert(nth == P.end());
+        }
+    }
+}
+
+int main() {
+    testBasic();
+    testComparator();
+    testStrings();
+    testPlain();
+    testRandom();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,290 @@
+// Parametr Alloc kolejki i PoolAllocator
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "minmaxheap.hh"
+#include "pairingheap.hh"
+#include "poolallocator.hh"
+#include "priorityqueue.hh"
+
+// Liczymy wywołania globalnego operatora new
+static long allocations = 0;
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// Bajty przydzielone i jeszcze nie zwrócone przez alokatory o danym id
+static std::map<int, long> live;
+
+// Alokator z identyfikatorem; alokatory są równe, gdy mają to samo id.
+// Propagate decyduje o propagate_on_container_*.
+template <typename T, bool Propagate>
+class tracking_allocator {
+   public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment =
+        std::integral_constant<bool, Propagate>;
+    using propagate_on_container_move_assignment =
+        std::integral_constant<bool, Propagate>;
+    using propagate_on_container_swap = std::integral_constant<bool, Propagate>;
+
+    template <typename U>
+    struct rebind {
+        using other = tracking_allocator<U, Propagate>;
+    };
+
+    int id;
+
+    explicit tracking_allocator(int id) : id(id) {}
+    template <typename U>
+    tracking_allocator(const tracking_allocator<U, Propagate>& other)
+        : id(other.id) {}
+
+    T* allocate(std::size_t n) {
+        live[id] += n * sizeof(T);
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept {
+        live[id] -= n * sizeof(T);
+        ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const tracking_allocator<U, Propagate>& other) const {
+        return id == other.id;
+    }
+    template <typename U>
+    bool operator!=(const tracking_allocator<U, Propagate>& other) const {
+        return id != other.id;
+    }
+};
+
+template <bool Propagate>
+using tracking = tracking_allocator<std::pair<const int, int>, Propagate>;
+
+template <bool Propagate, typename Backend = TreeBackend>
+using TrackedPQ = QueueFor<int, int, Backend, tracking<Propagate>>;
+
+bool nothing_live() {
+    for (const std::pair<const int, long>& l : live)
+        if (l.second != 0) return false;
+    return true;
+}
+
+std::vector<std::pair<int, int>> pairs(int n, int shift) {
+    std::vector<std::pair<int, int>> out;
+    for (int i = 0; i < n; ++i) out.emplace_back(i, (i * 7 + shift) % n);
+    return out;
+}
+
+// Cała pamięć kolejki (także pomocniczych kontenerów) idzie przez Alloc
+void testTracking() {
+    {
+        TrackedPQ<false> P(tracking<false>(1));
+        assert(P.get_allocator().id == 1);
+        for (int i = 0; i < 100; ++i) P.insert(i, 100 - i);
+        assert(live[1] > 0);
+
+        std::vector<std::pair<int, int>> batch = pairs(50, 3);
+        P.insert_many(batch.begin(), batch.end());
+        P.changeValues(batch.begin(), batch.begin() + 20);
+
+        TrackedPQ<false> Q(P);
+        assert(Q.get_allocator().id == 1 && Q == P);
+        TrackedPQ<false> R(P, tracking<false>(2));
+        assert(R.get_allocator().id == 2 && R == P && live[2] > 0);
+
+        TrackedPQ<false> S(batch.begin(), batch.end(), tracking<false>(3));
+        assert(S.get_allocator().id == 3 && S.size() == 50);
+    }
+    assert(nothing_live());
+}
+
+// Bez propagacji przypisanie zachowuje alokator celu
+void testNoPropagation() {
+    {
+        TrackedPQ<false> P(tracking<false>(1)), Q(tracking<false>(2));
+        for (int i = 0; i < 50; ++i) P.insert(i, i);
+
+        Q = P;
+        assert(Q.get_allocator().id == 2 && Q == P);
+
+        TrackedPQ<false> R(tracking<false>(3));
+        R = std::move(Q);
+        assert(R.get_allocator().id == 3 && R == P);
+
+        // te same alokatory - przeniesienie bez kopiowania
+        TrackedPQ<false> S(tracking<false>(1));
+        S = std::move(P);
+        assert(S.get_allocator().id == 1 && S.size() == 50 && P.empty());
+    }
+    assert(nothing_live());
+}
+
+void testPropagation() {
+    {
+        TrackedPQ<true> P(tracking<true>(1)), Q(tracking<true>(2));
+        for (int i = 0; i < 50; ++i) P.insert(i, i);
+
+        Q = P;
+        assert(Q.get_allocator().id == 1 && Q == P);
+
+        TrackedPQ<true> R(tracking<true>(3));
+        R = std::move(Q);
+        assert(R.get_allocator().id == 1 && R == P);
+        assert(live[2] == 0 && live[3] == 0);
+
+        R.swap(P);
+        assert(R.get_allocator().id == 1);
+    }
+    assert(nothing_live());
+}
+
+// Scalenie kolejek z różnymi alokatorami kopiuje węzły queue, a queue
+// zostaje pusta i nie trzyma już pamięci
+template <typename Backend>
+void testMergeAcross() {
+    {
+        TrackedPQ<false, Backend> P(tracking<false>(1)),
+            Q(tracking<false>(2));
+        for (int i = 0; i < 100; ++i) P.insert(i, i);
+        for (int i = 0; i < 100; ++i) Q.insert(i + 100, 200 - i);
+        P.merge(Q);
+        assert(P.size() == 200 && Q.empty());
+        assert(P.get_allocator().id == 1 && Q.get_allocator().id == 2);
+        assert(live[2] == 0);
+        assert(P.minValue() == 0 && P.minKey() == 0);
+        for (int i = 0; i < 200; ++i) P.deleteMin();
+        assert(P.empty());
+    }
+    assert(nothing_live());
+}
+
+// Po takim scaleniu queue zostaje przy swoim ograniczeniu rozmiaru
+void testMergeAcrossCapacity() {
+    {
+        TrackedPQ<false> P(tracking<false>(1)), Q(tracking<false>(2));
+        Q.set_capacity(3);
+        for (int i = 0; i < 10; ++i) Q.insert(i, i);
+        P.merge(Q);
+        assert(P.size() == 3 && P.minValue() == 7);
+        assert(Q.empty() && Q.capacity() == 3 && live[2] == 0);
+        for (int i = 0; i < 5; ++i) Q.insert(i, i);
+        assert(Q.size() == 3 && Q.minValue() == 2);
+    }
+    assert(nothing_live());
+}
+
+template <typename Backend>
+using PooledPQ =
+    QueueFor<int, int, Backend, PoolAllocator<std::pair<const int, int>>>;
+
+// Z pulą kolejka zachowuje się tak samo jak z domyślnym alokatorem
+template <typename Backend>
+void testPooled() {
+    PooledPQ<Backend> P;
+    QueueFor<int, int, Backend> M;
+    for (int i = 0; i < 5000; ++i) {
+        int key = (i * 37) % 1000, value = (i * 7919) % 4001;
+        P.insert(key, value);
+        M.insert(key, value);
+        if (i % 3 == 0) {
+            P.changeValue(key, value / 2);
+            M.changeValue(key, value / 2);
+        }
+        if (i % 5 == 0) {
+            P.deleteMin();
+            M.deleteMin();
+        }
+    }
+
+    PooledPQ<Backend> Q(P), R;
+    assert(Q.get_allocator() == P.get_allocator());
+    assert(R.get_allocator() != P.get_allocator());
+    R = Q;
+    assert(R.get_allocator() == P.get_allocator());
+
+    PooledPQ<Backend> S;
+    for (int i = 0; i < 100; ++i) S.insert(i, -i);
+    R.merge(S);
+    assert(S.empty() && R.size() == P.size() + 100);
+
+    while (!M.empty()) {
+        assert(P.minValue() == M.minValue() && P.minKey() == M.minKey());
+        P.deleteMin();
+        M.deleteMin();
+    }
+    assert(P.empty());
+}
+
+void testPoolAllocator() {
+    PoolAllocator<int> a, b;
+    PoolAllocator<double> c(a);
+    assert(a == c && a != b);
+
+    // zwolnione bloki są używane ponownie
+    int* p = a.allocate(3);
+    a.deallocate(p, 3);
+    int* q = a.allocate(4);
+    assert(p == q);
+    a.deallocate(q, 4);
+
+    // duże bloki idą prosto do operator new
+    long before = allocations;
+    char* big = PoolAllocator<char>(a).allocate(2 << 20);
+    assert(allocations == before + 1);
+    PoolAllocator<char>(a).deallocate(big, 2 << 20);
+}
+
+// Partie insert_many zajmują wolne miejsca kolejki, a pomocnicze kontenery
+// biorą bloki z puli - po rozgrzaniu wstawianie partii i usuwanie minimów
+// nie woła operator new
+void testChurn() {
+    PooledPQ<TreeBackend> P;
+    // pary, które zostają w kolejce, żeby partie były naprawdę scalane
+    for (int i = 0; i < 64; ++i) P.insert(i, 1 << 30);
+    std::vector<std::pair<int, int>> batch = pairs(64, 0);
+    for (int round = 0; round < 100; ++round) {
+        for (std::pair<int, int>& p : batch) p.second += 64;
+        P.insert_many(batch.begin(), batch.end());
+        for (int i = 0; i < 64; ++i) P.deleteMin();
+    }
+    long before = allocations;
+    for (int round = 0; round < 1000; ++round) {
+        for (std::pair<int, int>& p : batch) p.second += 64;
+        P.insert_many(batch.begin(), batch.end());
+        for (int i = 0; i < 64; ++i) P.deleteMin();
+    }
+    assert(allocations == before);
+    assert(P.size() == 64);
+}
+
+int main() {
+    testTracking();
+    testNoPropagation();
+    testPropagation();
+    testMergeAcross<TreeBackend>();
+    testMergeAcross<PairingHeapBackend>();
+    testMergeAcross<MinMaxHeapBackend>();
+    testMergeAcrossCapacity();
+    testPooled<TreeBackend>();
+    testPooled<PairingHeapBackend>();
+    testPooled<MinMaxHeapBackend>();
+    testPoolAllocator();
+    testChurn();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "priorityqueue.hh"
+#include "test_common.hh"
+
+using PQ = PriorityQueue<int, int>;
+
+void testBasic() {
+    PQ P;
+    try {
+        P.popMin();
+        assert(!"P.popMin() on empty P did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+    try {
+        P.popMax();
+        assert(!"P.popMax() on empty P did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+
+    P.insert(1, 10);
+    P.insert(2, 30);
+    P.insert(3, 20);
+    P.insert(3, 20);
+    assert(P.popMin() == std::make_pair(1, 10));
+    assert(P.popMax() == std::make_pair(2, 30));
+    // powtórzenia schodzą po jednym
+    assert(P.popMin() == std::make_pair(3, 20));
+    assert(P.size() == 1 && P.minKey() == 3);
+    assert(P.popMax() == std::make_pair(3, 20));
+    assert(P.empty());
+}
+
+// Obiekt liczący kopie; przeniesienie nie rzuca
+struct Tracked {
+    static int copies;
+    std::string text;
+
+    explicit Tracked(const std::string& text) : text(text) {}
+    Tracked(const Tracked& other) : text(other.text) { ++copies; }
+    Tracked(Tracked&& other) noexcept : text(std::move(other.text)) {}
+    bool operator<(const Tracked& other) const { return text < other.text; }
+    bool operator==(const Tracked& other) const { return text == other.text; }
+};
+int Tracked::copies = 0;
+
+void testMove() {
+    PriorityQueue<Tracked, Tracked> P;
+    P.insert(Tracked("a"), Tracked("x"));
+    P.insert(Tracked("b"), Tracked("y"));
+    P.insert(Tracked("c"), Tracked("z"));
+    P.insert(Tracked("c"), Tracked("w"));
+    P.insert(Tracked("d"), Tracked("y"));
+    P.insert(Tracked("e"), Tracked("v"));
+    P.insert(Tracked("e"), Tracked("v"));
+
+    // Po wartości: (e, v) dwa razy, (c, w), (a, x), (b, y), (d, y), (c, z).
+    // Klucz "c" ma jeszcze parę (c, w) - kopia.
+    int before = Tracked::copies;
+    std::pair<Tracked, Tracked> c = P.popMax();
+    assert(c.first.text == "c" && c.second.text == "z");
+    assert(Tracked::copies == before + 2);
+
+    // powtórzenie pary - kopia; ostatnie powtórzenie już przenosimy
+    before = Tracked::copies;
+    std::pair<Tracked, Tracked> e1 = P.popMin();
+    assert(e1.first.text == "e" && Tracked::copies == before + 2);
+    std::pair<Tracked, Tracked> e2 = P.popMin();
+    assert(e2.first.text == "e" && e2.second.text == "v");
+    assert(Tracked::copies == before + 2);
+
+    // kopie wyłącznie tych par - przeniesienie
+    before = Tracked::copies;
+    assert(P.popMin().first.text == "c");
+    assert(P.popMin().second.text == "x");
+    assert(Tracked::copies == before);
+
+    // wartość "y" jest wspólna dla dwóch par
+    std::pair<Tracked, Tracked> b = P.popMin();
+    assert(b.first.text == "b" && b.second.text == "y");
+    assert(Tracked::copies == before + 2);
+    std::pair<Tracked, Tracked> d = P.popMin();
+    assert(d.first.text == "d" && d.second.text == "y");
+    assert(Tracked::copies == before + 2);
+    assert(P.empty());
+}
+
+// Rzucająca kopia wartości nie psuje kolejki
+void testStrongGuarantee() {
+    PriorityQueue<int, FragileCopy> P;
+    for (int i = 0; i < 10; ++i) P.insert(i, FragileCopy(i * 10));
+    auto backup = P;
+
+    throw_now = true;
+    expect_throw([&] { P.popMin(); });
+    expect_throw([&] { P.popMax(); });
+    throw_now = false;
+    assert(P == backup);
+    assert(P.popMax().second.v == 90);
+}
+
+void testRandom() {
+    std::mt19937 twister(42);
+    PriorityQueue<std::string, std::string> P;
+    std::multiset<std::pair<std::string, std::string>> expected;
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 4;
+        std::string key = "key " + std::to_string(twister() % 30);
+        std::string value = "value " + std::to_string(twister() % 50);
+        if (op <= 1 || expected.empty()) {
+            P.insert(key, value);
+            expected.emplace(value, key);
+        } else if (op == 2) {
+            // równe wartości - klucz rozstrzyga, jak w minKey()
+            std::pair<std::string, std::string> top = P.popMin();
+            auto it = expected.begin();
+            assert(top.first == it->second && top.second == it->first);
+            expected.erase(it);
+        } else {
+            std::pair<std::string, std::string> top = P.popMax();
+            auto it = std::prev(expected.end());
+            assert(top.first == it->second && top.second == it->first);
+            expected.erase(it);
+        }
+        assert(P.size() == expected.size());
+    }
+}
+
+int main() {
+    testBasic();
+    testMove();
+    testStrongGuarantee();
+    testRandom();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
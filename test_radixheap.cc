@@ -0,0 +1,226 @@
+#include <cassert>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "radixheap.hh"
+
+using PQ = HeapQueue<int, unsigned, RadixHeapBackend>;
+
+PQ f(PQ q) { return q; }
+
+void testBasic() {
+    PQ P = f(PQ());
+    assert(P.empty());
+
+    P.insert(1, 42);
+    P.insert(2, 42);
+    P.insert(3, 1000);
+
+    assert(P.size() == 3);
+    assert(P.minValue() == 42);
+
+    PQ Q(f(P));
+    Q.deleteMin();
+    Q.deleteMin();
+    assert(Q.minKey() == 3 && Q.minValue() == 1000);
+    Q.deleteMin();
+    Q.deleteMin();
+    assert(Q.empty());
+
+    try {
+        Q.minKey();
+        assert(!"Q.minKey() on empty Q did not throw!");
+    } catch (const PriorityQueueEmptyException&) {
+    }
+
+    // pusta kolejka może zacząć od mniejszej wartości
+    Q.insert(4, 7);
+    assert(Q.minValue() == 7);
+
+    PQ S;
+    S = P;
+    try {
+        S.changeValue(5, 400);
+        assert(!"did not throw");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+    S.changeValue(3, 50);
+    S.changeValue(1, 60);
+    assert(S.minKey() == 2 && S.minValue() == 42);
+    S.deleteMin();
+    assert(S.minKey() == 3 && S.minValue() == 50);
+
+    // minimum scalonej kolejki to mniejsze z minimów
+    PQ T;
+    T.insert(6, 10);
+    T.insert(7, 55);
+    S.merge(T);
+    assert(T.empty() && S.size() == 4);
+    assert(S.minKey() == 6 && S.minValue() == 10);
+    S.changeValue(7, 11);
+    S.deleteMin();
+    assert(S.minKey() == 7);
+
+    S = P;
+    swap(P, T);
+    assert(T == S);
+    assert(T != P);
+    assert(Q < T && !(T < Q));
+
+    P = std::move(S);
+    assert(T != S);
+    assert(T == P);
+}
+
+// Wartości ze znakiem i zmiennoprzecinkowe zachowują porządek
+void testCodes() {
+    HeapQueue<int, int, RadixHeapBackend> I;
+    I.insert(1, std::numeric_limits<int>::min());
+    I.insert(2, -1);
+    I.insert(3, 0);
+    I.insert(4, std::numeric_limits<int>::max());
+    for (int key = 1; key <= 4; ++key) {
+        assert(I.minKey() == key);
+        I.deleteMin();
+    }
+
+    HeapQueue<int, double, RadixHeapBackend> D;
+    std::vector<double> values = {-1e300, -2.5, -0.5, 0.0, 1e-300, 0.75,
+                                  3.0, 1e300,
+                                  std::numeric_limits<double>::infinity()};
+    // pierwsza wartość jest najmniejsza, pozostałe w dowolnej kolejności
+    D.insert(-1, -std::numeric_limits<double>::infinity());
+    for (std::size_t i = values.size(); i-- > 0;)
+        D.insert(static_cast<int>(i), values[i]);
+    assert(D.minKey() == -1);
+    D.deleteMin();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        assert(D.minValue() == values[i]);
+        D.deleteMin();
+    }
+
+    HeapQueue<int, float, RadixHeapBackend> F;
+    F.insert(1, -3.5f);
+    F.insert(2, 2.0f);
+    F.changeValue(2, -3.0f);
+    F.insert(3, -3.25f);
+    assert(F.minKey() == 1);
+    F.deleteMin();
+    assert(F.minKey() == 3);
+    F.deleteMin();
+    assert(F.minKey() == 2 && F.minValue() == -3.0f);
+}
+
+// Dijkstra na losowym grafie z changeValue jako zmniejszeniem klucza daje te
+// same odległości co silnik drzewiasty
+template <typename Backend>
+std::vector<unsigned> dijkstra(
+    const std::vector<std::vector<std::pair<int, unsigned>>>& graph) {
+    std::vector<unsigned> dist(graph.size(),
+                               std::numeric_limits<unsigned>::max());
+    std::vector<bool> done(graph.size());
+    QueueFor<int, unsigned, Backend> P;
+    dist[0] = 0;
+    P.insert(0, 0);
+    while (!P.empty()) {
+        int u = P.minKey();
+        P.deleteMin();
+        done[u] = true;
+        for (const auto& edge : graph[u]) {
+            int v = edge.first;
+            unsigned d = dist[u] + edge.second;
+            if (done[v] || d >= dist[v]) continue;
+            if (dist[v] == std::numeric_limits<unsigned>::max())
+                P.insert(v, d);
+            else
+                P.changeValue(v, d);
+            dist[v] = d;
+        }
+    }
+    return dist;
+}
+
+void testDijkstra() {
+    std::mt19937 twister(5);
+    const int n = 2000;
+    std::vector<std::vector<std::pair<int, unsigned>>> graph(n);
+    for (int u = 0; u < n; ++u)
+        for (int i = 0; i < 6; ++i)
+            graph[u].emplace_back(twister() % n, twister() % 1000);
+    assert(dijkstra<RadixHeapBackend>(graph) == dijkstra<TreeBackend>(graph));
+}
+
+void testRandom() {
+    std::mt19937 twister(42);
+    PQ P;
+    std::multiset<std::pair<unsigned, int>> expected;  // (wartość, klucz)
+    unsigned floor = 0;
+    for (int i = 0; i < 20000; ++i) {
+        int op = twister() % 5;
+        int key = twister() % 50;
+        unsigned value = floor + twister() % (1u << (twister() % 24));
+        if (op <= 1) {
+            P.insert(key, value);
+            expected.emplace(value, key);
+        } else if (op == 2) {
+            if (!expected.empty()) {
+                assert(P.minValue() == expected.begin()->first);
+                expected.erase(expected.find(
+                    std::make_pair(P.minValue(), P.minKey())));
+                P.deleteMin();
+            }
+        } else if (op == 3) {
+            // other też jest monotoniczna: wartości rosną od jej pierwszej
+            PQ other;
+            unsigned v = floor;
+            for (int j = twister() % 3; j > 0; --j) {
+                int k = twister() % 50;
+                v += twister() % 100000;
+                other.insert(k, v);
+                expected.emplace(v, k);
+            }
+            P.merge(other);
+            assert(other.empty());
+        } else {
+            auto it = expected.begin();
+            while (it != expected.end() && it->second != key) ++it;
+            try {
+                P.changeValue(key, value);
+                assert(it != expected.end());
+            } catch (PriorityQueueNotFoundException&) {
+                assert(it == expected.end());
+                continue;
+            }
+            // zmieniona para jest dowolna - zsynchronizujmy się z kopią
+            PQ copy(P);
+            assert(copy == P);
+            expected.clear();
+            while (!copy.empty()) {
+                expected.emplace(copy.minValue(), copy.minKey());
+                copy.deleteMin();
+            }
+        }
+        assert(P.size() == expected.size());
+        // odczytane minimum też podnosi dolne ograniczenie wartości
+        if (!expected.empty()) {
+            assert(P.minValue() == expected.begin()->first);
+            floor = P.minValue();
+        } else {
+            floor = 0;
+        }
+    }
+}
+
+int main() {
+    testBasic();
+    testCodes();
+    testDijkstra();
+    testRandom();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Liczniki trybu pomiarowego; kompilować z -DPRIORITY_QUEUE_STATS
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "priorityqueue.hh"
+
+#ifndef PRIORITY_QUEUE_STATS
+#error "test_stats.cc needs -DPRIORITY_QUEUE_STATS"
+#endif
+
+using PQ = PriorityQueue<int, int>;
+using S = PriorityQueueStats;
+
+bool zero(const PriorityQueueCounters& c) {
+    return c.calls == 0 && c.allocations == 0 && c.bytes == 0 &&
+           c.comparisons == 0 && c.nodes == 0;
+}
+
+void testMethods() {
+    PQ P;
+    assert(zero(P.stats().total()));
+
+    // pierwszy węzeł - jedna alokacja puli, bez porównań (małe klucze
+    // i wartości siedzą w węźle, więc pule kopii nic nie alokują)
+    P.insert(1, 10);
+    const PriorityQueueCounters& ins = P.stats()[S::insert];
+    assert(ins.calls == 1 && ins.allocations == 1 && ins.bytes > 0);
+    assert(ins.comparisons == 0);
+
+    // kolejne mieszczą się w pierwszym kawałku puli
+    P.insert(2, 20);
+    P.insert(3, 5);
+    assert(ins.calls == 3 && ins.allocations == 1 && ins.comparisons > 0);
+    assert(ins.nodes > 0);
+
+    // usuwanie nie porównuje
+    P.deleteMin();
+    assert(P.stats()[S::deleteMin].calls == 1);
+    assert(P.stats()[S::deleteMin].comparisons == 0);
+
+    assert(P.minValue() == 10 && P.maxKey() == 2);
+    assert(P.stats()[S::extremes].calls == 2);
+
+    // nieudane wywołanie też się liczy
+    try {
+        P.changeValue(7, 1);
+        assert(!"changeValue on a missing key did not throw!");
+    } catch (const PriorityQueueNotFoundException&) {
+    }
+    assert(P.stats()[S::changeValue].calls == 1);
+    assert(P.stats()[S::changeValue].comparisons > 0);
+
+    // równe kolejki - po jednym porównaniu klucza i wartości na parę
+    PQ Q(P);
+    assert(Q.stats()[S::copy].calls == 1);
+    assert(Q.stats()[S::copy].allocations > 0);
+    assert(P.stats()[S::copy].calls == 0);
+    std::size_t before = P.stats()[S::equal].comparisons;
+    assert(P == Q);
+    assert(P.stats()[S::equal].comparisons - before == 2 * P.size());
+    assert(P.stats()[S::equal].calls == 1 && Q.stats()[S::equal].calls == 0);
+    assert(!(P < Q) && P.stats()[S::less].calls == 1);
+
+    P.reset_stats();
+    assert(zero(P.stats().total()));
+}
+
+// Metoda zewnętrzna przejmuje liczniki metod wywołanych w środku
+void testNesting() {
+    PQ P;
+    std::vector<std::pair<int, int>> pairs;
+    for (int i = 0; i < 100; ++i) pairs.emplace_back(i, 100 - i);
+    P.insert_many(pairs.begin(), pairs.end());
+    P.insert_many(pairs.begin(), pairs.end());
+    assert(P.stats()[S::insert_many].calls == 2);
+    assert(P.stats()[S::insert_many].comparisons > 0);
+    assert(P.stats()[S::insert_many].allocations > 0);
+    assert(P.stats()[S::merge].calls == 0 && P.stats()[S::build].calls == 0);
+
+    P.changeValues(pairs.begin(), pairs.begin() + 10);
+    assert(P.stats()[S::changeValues].calls == 1);
+    assert(P.stats()[S::insert].calls == 0);
+    assert(P.stats()[S::changeValue].calls == 0);
+
+    PQ Q(pairs.begin(), pairs.end());
+    assert(Q.stats()[S::build].calls == 1);
+    P.merge(Q);
+    assert(P.stats()[S::merge].calls == 1 && P.stats()[S::merge].nodes > 0);
+
+    // erase_all nie usuwa węzłów przez deleteMin ani changeValue
+    assert(P.erase_all(5) == 3);
+    assert(P.stats()[S::erase].calls == 1 && P.stats()[S::erase].nodes > 0);
+    assert(P.stats()[S::deleteMin].calls == 0);
+
+    PriorityQueueCounters sum = P.stats().total();
+    assert(sum.calls == 5);
+    assert(std::string(S::name(S::changeValues)) == "changeValues");
+    assert(std::string(S::name(S::erase)) == "erase");
+}
+
+// Duże klucze idą do puli kopii (osobna alokacja), małe wartości nie;
+// równy klucz nie jest kopiowany drugi raz
+void testInterning() {
+    PriorityQueue<std::string, int> P;
+    const std::string key(100, 'k');
+    P.insert(key, 1);
+    assert(P.stats()[S::insert].allocations == 2);
+    for (int i = 2; i < 10; ++i) P.insert(key, i);
+    assert(P.stats()[S::insert].allocations == 2);
+}
+
+int main() {
+    testMethods();
+    testNesting();
+    testInterning();
+    std::cout << "ALL OK!" << std::endl;
+    return 0;
+}